@@ -0,0 +1,220 @@
+#include <cstdlib>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "synthetic_data.hpp"
+
+// Benchmarks of the import, the conversion, the filters and the export on generated files.
+// The number of rows is set with the environment variable MCSV_BENCH_ROWS (default 1M),
+// the files are generated once into the temporary directory and reused by later runs.
+
+using mcsv_bench::layout;
+
+static std::size_t bench_rows()
+{
+    const char *rows = std::getenv("MCSV_BENCH_ROWS");
+    return rows ? std::stoul(rows) : 1'000'000ul;
+}
+
+/// @brief the narrow file, loaded once per loader type
+template<class loader_t>
+static const mcsv::dataframe<loader_t> &narrow_df()
+{
+    static const mcsv::dataframe<loader_t> df(mcsv_bench::cached_csv(bench_rows(), layout::narrow));
+    return df;
+}
+
+/// @brief one thread and, if available, all hardware threads
+static std::vector<std::int64_t> thread_counts()
+{
+    std::vector<std::int64_t> counts = {1};
+
+    if( std::thread::hardware_concurrency() > 1 )
+        counts.push_back(std::thread::hardware_concurrency());
+
+    return counts;
+}
+
+static std::size_t threads_arg(const benchmark::State &state)
+{
+    return static_cast<std::size_t>(state.range(1));
+}
+
+// import, args: layout, threads
+template<class loader_t>
+static void BM_import(benchmark::State &state)
+{
+    const auto path = mcsv_bench::cached_csv(bench_rows(), static_cast<layout>(state.range(0)));
+    const auto options = mcsv::make_load_options(mcsv::parallel{threads_arg(state)});
+
+    for(auto _ : state)
+    {
+        loader_t loader(path, options);
+        benchmark::DoNotOptimize(loader.data().size());
+    }
+
+    state.SetLabel(mcsv_bench::layout_name(static_cast<layout>(state.range(0))));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(std::filesystem::file_size(path)));
+}
+
+static void import_args(benchmark::internal::Benchmark *b)
+{
+    for(auto l : {layout::narrow, layout::wide, layout::quoted})
+        for(auto threads : thread_counts())
+            b->Args({static_cast<std::int64_t>(l), threads});
+
+    b->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_TEMPLATE(BM_import, mcsv::default_loader)->Apply(import_args);
+BENCHMARK_TEMPLATE(BM_import, mcsv::mmap_loader)->Apply(import_args);
+BENCHMARK_TEMPLATE(BM_import, mcsv::columnar_loader)->Apply(import_args);
+
+// conversion of the cells of the value column
+static void BM_convert(benchmark::State &state)
+{
+    static const mcsv::mmap_loader loader(mcsv_bench::cached_csv(bench_rows(), layout::narrow));
+    const auto &table = loader.data();
+
+    for(auto _ : state)
+        for(const auto &row : table)
+            benchmark::DoNotOptimize(mcsv::convert<double>(row[1]));
+
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(table.size()));
+}
+
+BENCHMARK(BM_convert)->Unit(benchmark::kMillisecond);
+
+// filter operators on a numeric and on a string column
+template<class loader_t>
+static void BM_filter_less(benchmark::State &state)
+{
+    const auto &df = narrow_df<loader_t>();
+
+    for(auto _ : state)
+        benchmark::DoNotOptimize(( df("value") < std::tuple(500.0) ).rows());
+
+    state.SetItemsProcessed(state.iterations() * df.rows());
+}
+
+template<class loader_t>
+static void BM_filter_greater_equal(benchmark::State &state)
+{
+    const auto &df = narrow_df<loader_t>();
+
+    for(auto _ : state)
+        benchmark::DoNotOptimize(( df("value") >= std::tuple(990.0) ).rows());
+
+    state.SetItemsProcessed(state.iterations() * df.rows());
+}
+
+template<class loader_t>
+static void BM_filter_equal(benchmark::State &state)
+{
+    const auto &df = narrow_df<loader_t>();
+
+    for(auto _ : state)
+        benchmark::DoNotOptimize(( df("category") == std::tuple(std::string("cat3")) ).rows());
+
+    state.SetItemsProcessed(state.iterations() * df.rows());
+}
+
+template<class loader_t>
+static void BM_filter_not_equal(benchmark::State &state)
+{
+    const auto &df = narrow_df<loader_t>();
+
+    for(auto _ : state)
+        benchmark::DoNotOptimize(( df("category") != std::tuple(std::string("cat3")) ).rows());
+
+    state.SetItemsProcessed(state.iterations() * df.rows());
+}
+
+template<class loader_t>
+static void BM_is_in(benchmark::State &state)
+{
+    const auto &df = narrow_df<loader_t>();
+
+    std::mt19937_64 gen(7);
+    std::uniform_int_distribution<std::int64_t> id(0, df.rows() - 1);
+    std::vector<std::int64_t> ids(static_cast<std::size_t>(state.range(0)));
+    for(auto &i : ids)
+        i = id(gen);
+
+    for(auto _ : state)
+        benchmark::DoNotOptimize(df("id").is_in(ids).rows());
+
+    state.SetItemsProcessed(state.iterations() * df.rows());
+}
+
+// the id column is sorted, so the zone map skips all blocks except the first
+template<class loader_t>
+static void BM_filter_zone_map(benchmark::State &state)
+{
+    static const auto df = []() {
+        mcsv::dataframe<loader_t> indexed(mcsv_bench::cached_csv(bench_rows(), layout::narrow));
+        indexed.build_index();
+        return indexed;
+    }();
+
+    for(auto _ : state)
+        benchmark::DoNotOptimize(( df("id") < std::tuple(std::int64_t{1000}) ).rows());
+
+    state.SetItemsProcessed(state.iterations() * df.rows());
+}
+
+BENCHMARK_TEMPLATE(BM_filter_less, mcsv::default_loader)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_filter_less, mcsv::columnar_loader)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_filter_greater_equal, mcsv::default_loader)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_filter_greater_equal, mcsv::columnar_loader)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_filter_equal, mcsv::default_loader)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_filter_equal, mcsv::columnar_loader)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_filter_not_equal, mcsv::default_loader)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_filter_not_equal, mcsv::columnar_loader)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_filter_zone_map, mcsv::default_loader)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_filter_zone_map, mcsv::columnar_loader)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_is_in, mcsv::default_loader)->Arg(16)->Arg(100'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_is_in, mcsv::columnar_loader)->Arg(16)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+// export, args: unused, threads
+template<class loader_t>
+static void BM_cols_to_vectors(benchmark::State &state)
+{
+    const auto &df = narrow_df<loader_t>();
+
+    for(auto _ : state)
+        benchmark::DoNotOptimize(df("id", "value").template cols_to_vectors<std::int64_t, double>(mcsv::parallel{threads_arg(state)}));
+
+    state.SetItemsProcessed(state.iterations() * df.rows());
+}
+
+#ifdef MCSV_EIGEN_SUPPORT
+template<class loader_t>
+static void BM_to_eigen_array(benchmark::State &state)
+{
+    const auto &df = narrow_df<loader_t>();
+
+    for(auto _ : state)
+        benchmark::DoNotOptimize(df("id", "value").template to_eigen_array<double>(mcsv::parallel{threads_arg(state)}).sum());
+
+    state.SetItemsProcessed(state.iterations() * df.rows());
+}
+#endif
+
+static void export_args(benchmark::internal::Benchmark *b)
+{
+    for(auto threads : thread_counts())
+        b->Args({0, threads});
+
+    b->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_TEMPLATE(BM_cols_to_vectors, mcsv::default_loader)->Apply(export_args);
+BENCHMARK_TEMPLATE(BM_cols_to_vectors, mcsv::columnar_loader)->Apply(export_args);
+#ifdef MCSV_EIGEN_SUPPORT
+BENCHMARK_TEMPLATE(BM_to_eigen_array, mcsv::default_loader)->Apply(export_args);
+BENCHMARK_TEMPLATE(BM_to_eigen_array, mcsv::columnar_loader)->Apply(export_args);
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,64 @@
+#include <random>
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+#include <mcsv/mcsv.hpp>
+
+// Compares the std::from_chars based mcsv::convert with the
+// std::stringstream based conversion, which was used before.
+
+template<class T>
+static auto make_cells(std::size_t n)
+{
+    std::mt19937 gen(42);
+    std::vector<std::string> cells;
+    cells.reserve(n);
+
+    for(std::size_t i=0; i<n; ++i)
+    {
+        if constexpr( std::is_integral_v<T> )
+            cells.push_back(std::to_string(std::uniform_int_distribution<T>(-1'000'000, 1'000'000)(gen)));
+        else
+            cells.push_back(fmt::format("{}", std::uniform_real_distribution<T>(-1e6, 1e6)(gen)));
+    }
+
+    return cells;
+}
+
+template<class T>
+static void BM_stringstream(benchmark::State &state)
+{
+    const auto cells = make_cells<T>(static_cast<std::size_t>(state.range(0)));
+
+    for(auto _ : state)
+    {
+        for(const auto &cell : cells)
+        {
+            T val{};
+            std::stringstream sstr(cell);
+            sstr >> val;
+            benchmark::DoNotOptimize(val);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class T>
+static void BM_convert(benchmark::State &state)
+{
+    const auto cells = make_cells<T>(static_cast<std::size_t>(state.range(0)));
+
+    for(auto _ : state)
+        for(const auto &cell : cells)
+            benchmark::DoNotOptimize(mcsv::convert<T>(cell));
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_stringstream, int)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_convert, int)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_stringstream, double)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_convert, double)->Arg(1 << 16);
+
+BENCHMARK_MAIN();
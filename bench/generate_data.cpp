@@ -0,0 +1,33 @@
+#include <iostream>
+
+#include "synthetic_data.hpp"
+
+// Writes a synthetic csv-file, e.g. for profiling with large files:
+//   generate_data <path> <rows> [narrow|wide|quoted]
+
+int main(int argc, char **argv)
+{
+    if( argc < 3 )
+    {
+        std::cerr << "usage: " << argv[0] << " <path> <rows> [narrow|wide|quoted]\n";
+        return 1;
+    }
+
+    const std::string name = argc > 3 ? argv[3] : "narrow";
+    auto l = mcsv_bench::layout::narrow;
+
+    if( name == "wide" )
+        l = mcsv_bench::layout::wide;
+    else if( name == "quoted" )
+        l = mcsv_bench::layout::quoted;
+    else if( name != "narrow" )
+    {
+        std::cerr << "unknown layout '" << name << "'\n";
+        return 1;
+    }
+
+    mcsv_bench::write_csv(argv[1], std::stoul(argv[2]), l);
+    std::cout << "wrote " << std::filesystem::file_size(argv[1]) << " bytes to " << argv[1] << "\n";
+
+    return 0;
+}
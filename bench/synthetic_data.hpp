@@ -0,0 +1,115 @@
+#ifndef MCSV_SYNTHETIC_DATA_HPP
+#define MCSV_SYNTHETIC_DATA_HPP
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <mcsv/mcsv.hpp>
+
+// Generator for synthetic csv-files, which are used by the benchmarks and the generate_data tool.
+
+namespace mcsv_bench {
+
+/// @brief shape of a generated csv-file
+enum class layout
+{
+    narrow,     // id, value, category, flag
+    wide,       // id and 63 floating point columns
+    quoted      // id, value, and a text column, where every fourth cell is quoted and contains commas, quotes or line breaks
+};
+
+inline const char *layout_name(layout l)
+{
+    switch( l )
+    {
+    case layout::narrow: return "narrow";
+    case layout::wide: return "wide";
+    case layout::quoted: return "quoted";
+    }
+
+    return "";
+}
+
+/// @brief number of distinct values of the category column of the narrow layout
+constexpr std::int64_t categories = 16;
+
+/// @brief writes a csv-file with header and the given number of rows. The file is generated
+/// in blocks of 1 MiB, so also files with 100M rows can be generated quickly.
+/// The id column contains 0 ... rows-1, the value column uniformly distributed numbers in [0, 1000).
+inline void write_csv(const std::filesystem::path &path, std::size_t rows, layout l, unsigned seed = 42)
+{
+    std::ofstream file(path, std::ios::binary);
+
+    if( !file )
+        throw std::runtime_error("could not open '" + path.string() + "'!");
+
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> value(0.0, 1000.0);
+    std::uniform_int_distribution<std::int64_t> category(0, categories - 1);
+
+    constexpr int wide_cols = 63;
+
+    fmt::memory_buffer buffer;
+    const auto out = std::back_inserter(buffer);
+
+    switch( l )
+    {
+    case layout::narrow: fmt::format_to(out, "id,value,category,flag\n"); break;
+    case layout::quoted: fmt::format_to(out, "id,value,text\n"); break;
+    case layout::wide:
+        fmt::format_to(out, "id");
+        for(int c=0; c<wide_cols; ++c)
+            fmt::format_to(out, ",x{}", c);
+        fmt::format_to(out, "\n");
+        break;
+    }
+
+    for(std::size_t row=0ul; row<rows; ++row)
+    {
+        switch( l )
+        {
+        case layout::narrow:
+            fmt::format_to(out, "{},{:.3f},cat{},{}\n", row, value(gen), category(gen), row % 3 == 0 ? "true" : "false");
+            break;
+        case layout::wide:
+            fmt::format_to(out, "{}", row);
+            for(int c=0; c<wide_cols; ++c)
+                fmt::format_to(out, ",{:.4f}", value(gen));
+            fmt::format_to(out, "\n");
+            break;
+        case layout::quoted:
+            if( row % 4 == 0 )
+                fmt::format_to(out, "{},{:.3f},\"text {}, with \"\"quotes\"\"\nand a line break\"\n", row, value(gen), row);
+            else
+                fmt::format_to(out, "{},{:.3f},plain text {}\n", row, value(gen), row);
+            break;
+        }
+
+        if( buffer.size() > (1ul << 20) )
+        {
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+/// @brief returns the path of a generated file in the temporary directory, which is generated
+/// on the first request. Files, which already exist, are reused.
+inline std::filesystem::path cached_csv(std::size_t rows, layout l)
+{
+    const auto path = std::filesystem::temp_directory_path() /
+        fmt::format("mcsv_bench_{}_{}.csv", layout_name(l), rows);
+
+    if( !std::filesystem::exists(path) )
+        write_csv(path, rows, l);
+
+    return path;
+}
+
+} // namespace mcsv_bench
+
+#endif // MCSV_SYNTHETIC_DATA_HPP
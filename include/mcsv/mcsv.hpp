@@ -8,422 +8,5680 @@
 #include <ostream>
 #include <memory>
 #include <map>
+#include <numeric>
+#include <deque>
+#include <variant>
+#include <charconv>
+#include <limits>
+#include <cmath>
+#include <locale>
+#include <array>
+#include <optional>
+#include <sstream>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
+#include <tuple>
+#include <functional>
+#include <unordered_set>
+#include <unordered_map>
+
+#if defined(MCSV_ENABLE_TRACY) && __has_include(<tracy/Tracy.hpp>)
+#include <tracy/Tracy.hpp>
+#endif
+
+#if __has_include(<span>)
+#include <span>
+#endif
 
 #if __has_include(<Eigen/Dense>)
 #define MCSV_EIGEN_SUPPORT
 #include <Eigen/Dense>
 #endif
 
+#if defined(MCSV_ENABLE_ZLIB) && __has_include(<zlib.h>)
+#define MCSV_ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+
+#if defined(MCSV_ENABLE_ZSTD) && __has_include(<zstd.h>)
+#define MCSV_ZSTD_SUPPORT
+#include <zstd.h>
+#endif
+
+#if __has_include(<sys/mman.h>) && __has_include(<fcntl.h>) && __has_include(<unistd.h>)
+#define MCSV_MMAP_SUPPORT
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// SIMD instruction set for the structural scanning, chosen at compile time.
+// Can be disabled by defining MCSV_NO_SIMD.
+#if !defined(MCSV_NO_SIMD)
+#if defined(__AVX2__)
+#define MCSV_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MCSV_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define MCSV_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
 #define FMT_HEADER_ONLY
 #include <fmt/format.h>
 
 namespace mcsv {
 
-/// @brief Underlying data storage class. At the start loads the whole data into memory
-/// Maybe in future a kind of 'lazy-loader' could be useful
-class default_loader
+struct load_options;
+
+/// @brief Compile-time description of the format of a csv-file, which is passed as option tag,
+/// e.g. read_csv(path, mcsv::dialect<'|'>{}). Each dialect gets its own instantiation of the
+/// tokenizer, so the settings cost nothing while tokenizing.
+/// @tparam Delimiter character between the cells of a row
+/// @tparam Quote character which encloses quoted cells, '\0' disables quoting
+/// @tparam Trim whether leading and trailing whitespaces of unquoted cells are removed
+/// @tparam Comment rows starting with this character are skipped, '\0' disables comments
+/// @tparam Header whether the first row is the header. Otherwise the columns are named 0, 1, ...
+template<char Delimiter = ',', char Quote = '"', bool Trim = true, char Comment = '\0', bool Header = true>
+struct dialect
 {
-    std::vector<std::vector<std::string>> m_data;
-    std::vector<std::string> m_header;
+    static_assert( Delimiter != '\n' && Delimiter != '\0' && Delimiter != Quote && Delimiter != Comment,
+                   "invalid delimiter" );
 
-    std::map<std::string, std::size_t> m_header_map;
+    static constexpr char delimiter = Delimiter;
+    static constexpr char quote = Quote;
+    static constexpr bool trim = Trim;
+    static constexpr char comment = Comment;
+    static constexpr bool header = Header;
 
-    ///@brief turns a string into a std::vector of strings, based of a delimiter (, at the moment)
-    static auto extract_line(const std::string &line, std::optional<std::size_t> expected_size = std::nullopt)
+    /// @brief the settings as bytes, e.g. to identify the dialect in a snapshot
+    static std::string key()
     {
-        std::istringstream linestream(line);
-        std::vector<std::string> cells;
+        return { delimiter, quote, static_cast<char>(trim), comment, static_cast<char>(header) };
+    }
 
-        if( expected_size )
-            cells.reserve(*expected_size);
+    void apply(load_options &) const {}
+};
 
-        // leading whitespaces are erased by std::ws in loop header
-        for(std::string cell; std::getline(linestream >> std::ws, cell, ','); )
-        {
-            // trailing whitespaces are erased here
-            cell.erase(std::find_if(cell.rbegin(), cell.rend(), [](auto c) {
-                return !std::isspace(c);
-            }).base(), cell.end());
-            cells.push_back(cell);
-        }
+/// @brief tab-separated values, the tabs are not trimmed
+using tsv_dialect = dialect<'\t'>;
 
-        if( expected_size )
-            cells.resize(*expected_size);
+/// @brief pipe-separated values
+using pipe_dialect = dialect<'|'>;
 
-        return cells;
-    }
+template<class T>
+struct is_dialect : std::false_type {};
 
-    /// @brief ensures, that the header does not contain duplicates
-    static void throw_if_duplicates(std::vector<std::string> ref_header)
-    {
-        std::sort(ref_header.begin(), ref_header.end());
+template<char D, char Q, bool T, char C, bool H>
+struct is_dialect<dialect<D, Q, T, C, H>> : std::true_type {};
 
-        auto test_header = ref_header;
-        std::unique(test_header.begin(), test_header.end());
+/// @brief the first dialect in a list of option tags, or the default dialect
+template<class... options_t>
+struct find_dialect { using type = dialect<>; };
 
-        if( test_header != ref_header )
-            throw std::runtime_error("csv-file contains multiple columns with the same name!");
-    }
+template<class option_t, class... options_t>
+struct find_dialect<option_t, options_t...>
+{
+    using type = std::conditional_t<is_dialect<option_t>::value, option_t, typename find_dialect<options_t...>::type>;
+};
 
-public:
-    /// @brief constructs the loader, and loads all data to memory
-    default_loader(std::filesystem::path path)
-    {
-        if( !std::filesystem::exists(path) )
-            throw std::runtime_error("path '" + path.string() + "' does not exist!");
+template<class... options_t>
+using dialect_of_t = typename find_dialect<options_t...>::type;
 
-        std::ifstream file(path);
+/// @brief classes of bytes, which are relevant for the tokenizer
+enum class char_class : unsigned char { other, space, delimiter, quote, newline };
 
-        // header
-        std::string header_str;
-        std::getline(file, header_str, '\n');
+/// @brief builds a lookup table for the class of each byte of a dialect, independent of the
+/// locale. A delimiter, which is also a whitespace (e.g. a tab), is not trimmed.
+template<class dialect_t>
+constexpr auto make_char_class_table()
+{
+    std::array<char_class, 256> table{};
 
-        m_header = extract_line(header_str);
-        throw_if_duplicates(m_header);
-        for(std::size_t i=0ul; i<m_header.size(); ++i)
-            m_header_map[ m_header[i] ] = i;
+    if constexpr( dialect_t::trim )
+        for(char c : {' ', '\t', '\r', '\v', '\f'})
+            table[static_cast<unsigned char>(c)] = char_class::space;
 
-        // body
-        for( std::string line; std::getline(file, line, '\n'); )
-            m_data.push_back( extract_line(line, m_header.size()) );
+    table[static_cast<unsigned char>(dialect_t::delimiter)] = char_class::delimiter;
+    if constexpr( dialect_t::quote != '\0' )
+        table[static_cast<unsigned char>(dialect_t::quote)] = char_class::quote;
+    table[static_cast<unsigned char>('\n')] = char_class::newline;
 
-    }
+    return table;
+}
 
-    /// @brief getter for the body of the csv-file
-    const auto &data() const
-    {
-        return m_data;
-    }
+template<class dialect_t>
+inline constexpr auto char_class_table = make_char_class_table<dialect_t>();
 
-    /// @brief getter for the header of the csv-file
-    const auto &header() const
-    {
-        return m_header;
-    }
+/// @brief returns the index of the lowest set bit. Must not be called with 0.
+inline unsigned count_trailing_zeros(std::uint64_t bits)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx;
+    _BitScanForward64(&idx, bits);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(bits));
+#endif
+}
 
-    /// @brief getter for a map, which relates indices and column-headers
-    const auto &header_map() const
-    {
-        return m_header_map;
-    }
+/// @brief returns the number of set bits
+inline unsigned popcount(std::uint64_t bits)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return static_cast<unsigned>(__popcnt64(bits));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(bits));
+#endif
+}
 
-    /// @brief access a specific cell in the csv file
-    const auto &at(std::size_t row, std::size_t col) const
-    {
-        if( m_data.size() < row )
-            throw std::runtime_error(
-                fmt::format("{}: csv file has only {} rows, but row {} has been requested",
-                            m_data.size(), row, __func__));
+/// @brief bitmasks of the structural characters in a block of 64 bytes,
+/// bit i is set if byte i of the block is the respective character. The \r of a \r\n is
+/// no structural character, the tokenizer removes it from the end of the last cell.
+struct structural_masks
+{
+    std::uint64_t delimiter;
+    std::uint64_t quote;
+    std::uint64_t newline;
+};
 
-        if( m_header.size() < col )
-            throw std::runtime_error(
-                fmt::format("{}: csv file has only {} cols, but col {} has been requested",
-                            m_header.size(), col, __func__));
+#ifdef MCSV_SIMD_NEON
+/// @brief equivalent of _mm_movemask_epi8 for four compare results of 16 bytes each
+inline std::uint64_t neon_movemask(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3)
+{
+    const uint8x16_t weights = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+                                 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
 
-        return m_data[row][col];
-    }
-};
+    uint8x16_t sum0 = vpaddq_u8(vandq_u8(m0, weights), vandq_u8(m1, weights));
+    uint8x16_t sum1 = vpaddq_u8(vandq_u8(m2, weights), vandq_u8(m3, weights));
+    sum0 = vpaddq_u8(sum0, sum1);
+    sum0 = vpaddq_u8(sum0, sum0);
 
-/// @brief Dataframe class, which allows easy manipulation of rows and columns.
-/// When a manipulating operation is used, a new object is created with updated
-/// column- and row mask. No data are copied, since they are stored in a shared pointer.
-/// @tparam loader_t implementation of the data storage
-/// @tparam C non-type-template-parameter which stores the column-count or -1
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+#endif
 
-template<typename loader_t, int C = -1>
-class dataframe
+/// @brief vectorized structural scanning (similar to simdjson's stage 1): classifies
+/// 64 bytes at once with AVX2 (2x32 bytes), SSE2 or NEON (4x16 bytes), or a scalar loop
+/// @tparam delimiter_char the delimiter of the dialect
+/// @tparam quote_char the quote of the dialect, '\0' if quoting is disabled
+/// @param block pointer to at least 64 readable bytes
+template<char delimiter_char = ',', char quote_char = '"'>
+structural_masks scan_block(const char *block)
 {
-    std::shared_ptr<loader_t> m_loader;
+    structural_masks masks{};
 
-    const std::vector<bool> m_row_mask;
-    const std::vector<bool> m_col_mask;
+#if defined(MCSV_SIMD_AVX2)
+    const auto delimiter = _mm256_set1_epi8(delimiter_char);
+    const auto quote = _mm256_set1_epi8(quote_char);
+    const auto newline = _mm256_set1_epi8('\n');
 
-public:
-    /// @brief no default constructor
-    dataframe() = delete;
+    const auto bits = [](__m256i v, __m256i c) {
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, c))));
+    };
 
-    dataframe(std::filesystem::path path) :
-        m_loader(std::make_shared<loader_t>(path)),
-        m_row_mask(m_loader->data().size(), true),
-        m_col_mask(m_loader->header().size(), true)
+    for(int i=0; i<2; ++i)
     {
-        if( C != -1 && cols() != C )
-            throw std::runtime_error(
-                fmt::format("{}: compile-time column number (which is {}) mismatches run-time column number (which is {})",
-                            __func__, C, cols())
-            );
-    }
-
-private:
-    template<typename floader_t, int FC>
-    friend class dataframe;
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32 * i));
+        const auto shift = 32 * i;
 
-    /// @brief private constructor, used dataframe-manipulation
-    dataframe(std::shared_ptr<loader_t> loader,
-              const std::vector<bool> &row_mask,
-              const std::vector<bool> &col_mask) :
-        m_loader(loader),
-        m_row_mask(row_mask),
-        m_col_mask(col_mask)
-    {
-        if( C != -1 && cols() != C )
-            throw std::runtime_error(
-                fmt::format("{}: compile-time column number (which is {}) mismatches run-time column number (which is {})",
-                            __func__, C, cols())
-            );
+        masks.delimiter |= bits(v, delimiter) << shift;
+        masks.quote |= bits(v, quote) << shift;
+        masks.newline |= bits(v, newline) << shift;
     }
+#elif defined(MCSV_SIMD_SSE2)
+    const auto delimiter = _mm_set1_epi8(delimiter_char);
+    const auto quote = _mm_set1_epi8(quote_char);
+    const auto newline = _mm_set1_epi8('\n');
 
-    /// @brief wrapper-iterator, which holds a base iterator and a reference
-    /// to a mask, so it can iterate while respecting the mask. Therefore, each
-    /// iterator needs to know its end-iterator.
-    template<class base_iterator_t>
-    struct masked_iterator
-    {
-        base_iterator_t iter;
-        const base_iterator_t end_iter;
-        std::vector<bool>::const_iterator mask_it;
-
-        bool operator != (const masked_iterator & other) const {
-            return iter != other.iter;
-        }
-        void operator ++ () {
-            do {
-                ++mask_it;
-                ++iter;
-            }
-            while( iter != end_iter && !*mask_it );
-        }
-        auto operator *  () const {
-            return *iter;
-        }
+    const auto bits = [](__m128i v, __m128i c) {
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, c))));
     };
 
-    /// @brief helper-type, which enables range-based for-loops for masked iterators
-    template<class iterator_t>
-    struct iterable_wrapper
+    for(int i=0; i<4; ++i)
     {
-        const iterator_t begin_it, end_it;
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * i));
+        const auto shift = 16 * i;
 
-        auto begin() {
-            return begin_it;
-        }
-        auto end() {
-            return end_it;
-        }
+        masks.delimiter |= bits(v, delimiter) << shift;
+        masks.quote |= bits(v, quote) << shift;
+        masks.newline |= bits(v, newline) << shift;
+    }
+#elif defined(MCSV_SIMD_NEON)
+    const auto bytes = reinterpret_cast<const std::uint8_t *>(block);
+    const uint8x16_t v[4] = { vld1q_u8(bytes), vld1q_u8(bytes + 16), vld1q_u8(bytes + 32), vld1q_u8(bytes + 48) };
+
+    const auto bits = [&](std::uint8_t c) {
+        const auto cv = vdupq_n_u8(c);
+        return neon_movemask(vceqq_u8(v[0], cv), vceqq_u8(v[1], cv), vceqq_u8(v[2], cv), vceqq_u8(v[3], cv));
     };
 
-    /// @brief Static, private function which creates a masked-iterable
-    /// @param c Container over which will be iterated
-    /// @param mask Mask for the container. Must have the same size as the container
-    template<class container_t>
-    static auto masked_iterable(container_t &c,
-                                const std::vector<bool> &mask)
+    masks.delimiter = bits(static_cast<std::uint8_t>(delimiter_char));
+    masks.quote = bits(static_cast<std::uint8_t>(quote_char));
+    masks.newline = bits('\n');
+#else
+    for(unsigned i=0; i<64; ++i)
     {
-        using base_it_t = decltype(std::begin(std::declval<container_t>()));
+        const auto bit = std::uint64_t{1} << i;
 
-        if( c.size() != mask.size() )
-            throw std::runtime_error(
-                fmt::format("{}: tried to create masked iterable with wrong-sized mask", __func__)
-            );
+        if( block[i] == delimiter_char )
+            masks.delimiter |= bit;
+        else if( block[i] == quote_char )
+            masks.quote |= bit;
+        else if( block[i] == '\n' )
+            masks.newline |= bit;
+    }
+#endif
 
-        // prepare iterators to have correct start-point
-        auto base_it = c.begin();
-        auto mask_it = mask.begin();
+    // without quoting, the zero bytes are no quotes
+    if constexpr( quote_char == '\0' )
+        masks.quote = 0;
 
-        while( mask_it != mask.end() && !*mask_it )
-        {
-            ++base_it;
-            ++mask_it;
-        }
+    return masks;
+}
 
-        // initialize masked iterators
-        masked_iterator<base_it_t> begin_it{ base_it, c.end(), mask_it };
-        masked_iterator<base_it_t> end_it{ c.end(), c.end(), mask_it };
+/// @brief Hand-written CSV tokenizer, which scans a raw buffer exactly once. Cells are
+/// split at delimiters and rows at newlines, leading and trailing whitespaces of unquoted
+/// cells are trimmed in the same pass. Quoting follows RFC-4180: quoted cells may contain
+/// delimiters and newlines, and a quote is escaped by doubling it. Delimiters, newlines and
+/// quotes are found with the structural masks of scan_block(), so the bytes inside of a cell
+/// are not looked at one by one.
+/// @tparam dialect_t the mcsv::dialect, which sets the delimiter, quote, trimming and comments
+template<class dialect_t>
+class basic_tokenizer
+{
+    static constexpr char quote_char = dialect_t::quote;
 
-        return iterable_wrapper<decltype(begin_it)> { begin_it, end_it };
+    static auto classify(char c)
+    {
+        return char_class_table<dialect_t>[static_cast<unsigned char>(c)];
     }
 
-    /// @brief generic convert function from string. special handling for empty strings.
-    /// @tparam T type to which the string is converted
-    /// @param str string which will be converted
-    template<class T>
-    static auto convert(const std::string &str)
+    const char *m_begin;
+    const char *m_pos;
+    const char *m_end;
+
+    // structural masks of the block, which has been scanned last. Its offset is relative to
+    // m_begin and initialized such that the first call of find_next() always loads a block.
+    std::size_t m_block = std::size_t{0} - 64;
+    std::uint64_t m_cell_end_bits = 0;
+    std::uint64_t m_quote_bits = 0;
+
+    /// @brief scans the 64-byte block starting at block. The last block of the buffer
+    /// is copied to a zero-padded buffer first, so nothing is read out of bounds.
+    void load_block(const char *block)
     {
-        std::remove_const_t<std::remove_reference_t<T>> val{};
+        structural_masks masks;
 
-        if( std::is_arithmetic_v<T> && str.empty() )
+        if( m_end - block >= 64 )
         {
-            val = 0;
+            masks = scan_block<dialect_t::delimiter, quote_char>(block);
         }
         else
         {
-            std::stringstream sstr(str);
-            sstr >> val;
+            char padded[64] = {};
+            std::memcpy(padded, block, static_cast<std::size_t>(m_end - block));
+            masks = scan_block<dialect_t::delimiter, quote_char>(padded);
         }
-        return val;
+
+        m_block = static_cast<std::size_t>(block - m_begin);
+        m_cell_end_bits = masks.delimiter | masks.newline;
+        m_quote_bits = masks.quote;
     }
 
-    /// @brief convert helper function for vectors
-    template<class T>
-    static auto convert(const std::vector<std::string> &str_vec)
+    /// @brief finds the first delimiter or newline (or quote if quote is true) at or after p
+    /// @return the found position or the end of the buffer
+    template<bool quote>
+    const char *find_next(const char *p)
     {
-        std::vector<T> val_vec;
-        val_vec.reserve(str_vec.size());
+        while( p < m_end )
+        {
+            // blocks need no alignment, so a new block simply starts at p
+            auto offset = static_cast<std::size_t>(p - m_begin) - m_block;
 
-        for(auto &str : str_vec)
-            val_vec.push_back( convert<T>(str) );
+            if( offset >= 64 )
+            {
+                load_block(p);
+                offset = 0;
+            }
 
-        return val_vec;
-    }
+            const auto bits = (quote ? m_quote_bits : m_cell_end_bits) & (~std::uint64_t{0} << offset);
 
-    /// @brief helper function, which converts a std::tuple,
-    /// which is only allowed to contain std::strings, to a
-    /// std::array of std::strings
-    template<class tuple_t, std::size_t... idx>
-    static auto string_tuple_to_array(const tuple_t &tuple,
-                                      std::index_sequence<idx...>)
-    {
-        static_assert( std::tuple_size_v<tuple_t> == sizeof...(idx), "tuple size mismatches index_sequence size");
+            if( bits != 0 )
+                return m_begin + m_block + count_trailing_zeros(bits);
 
-        std::array<std::string, sizeof...(idx)> array;
-        ((std::get<idx>(array) = std::get<idx>(tuple)), ...);
-        return array;
+            p = m_begin + m_block + 64;
+        }
+
+        return m_end;
     }
 
-    /// @brief helper-function, which appends an array of strings to
-    /// a tuple of vectors
-    /// @param vector_tuple std::tuple of std::vectors with different types
-    /// @param array std::array of std::strings, which will be converted
-    template<class tuple_t, std::size_t... idx>
-    static void push_str_array_to_vector_tuple(tuple_t &vector_tuple,
-            const std::array<std::string, sizeof...(idx)> &array,
-            std::index_sequence<idx...>)
+    /// @brief skips the comment rows at m_pos
+    void skip_comments()
     {
-        static_assert( std::tuple_size_v<tuple_t> == sizeof...(idx), "tuple size mismatches index_sequence size");
-
-        (std::get<idx>(vector_tuple).push_back(
-             convert<typename std::remove_reference_t<decltype(std::get<idx>(vector_tuple))>::value_type>( std::get<idx>(array) )
-         ), ...);
+        if constexpr( dialect_t::comment != '\0' )
+        {
+            while( m_pos != m_end && *m_pos == dialect_t::comment )
+            {
+                const auto *newline = static_cast<const char *>(std::memchr(m_pos, '\n', static_cast<std::size_t>(m_end - m_pos)));
+                m_pos = newline ? newline + 1 : m_end;
+            }
+        }
     }
 
-    /// @brief static, private helber-function to implement the comparison operators.
-    /// @tparam tuple_t instance of std::tuple. The strings are converted in the contained types.
-    /// @param pred predicate, which is used to compare (std::less, std::equal_to, ...)
-    /// @param tuple tuple which will be compared to array
-    /// @param array array which will be compared to tuple after conversion to the specific type
-    template<class pred_t, class tuple_t, std::size_t... idx>
-    static bool compare_tuple_and_string_array(const pred_t &pred, const tuple_t &tuple,
-            const std::array<std::string, std::tuple_size_v<tuple_t>> &array,
-            std::index_sequence<idx...>)
+public:
+    using dialect_type = dialect_t;
+
+    basic_tokenizer(std::string_view buffer) :
+        m_begin(buffer.data()),
+        m_pos(buffer.data()),
+        m_end(buffer.data() + buffer.size())
     {
-        static_assert( std::tuple_size_v<tuple_t> == sizeof...(idx),
-                       "tuple and index_sequence have different size" );
+    }
 
-        //  convert(array[0]) == tuple[0]  &&  convert(array[1]) == tuple[1]  &&  ...
-        return (( pred( convert<decltype(std::get<idx>(tuple))>(std::get<idx>(array)), std::get<idx>(tuple) ) ) && ...);
+    /// @brief returns true, if the whole buffer has been tokenized
+    bool done() const
+    {
+        return m_pos == m_end;
     }
 
-    /// @brief helper-function to implement the comparison operators.
-    /// @param pred predicate, which is used to compare (std::less, std::equal_to, ...)
-    /// @param tuple each row is compared to the tuple
-    template<class pred_t, class tuple_t>
-    auto row_wise_comparison(const pred_t &pred, const tuple_t &tuple) const
+    /// @brief returns the position, at which the next row starts
+    const char *position() const
     {
-        constexpr std::size_t N = std::tuple_size_v<tuple_t>;
+        return m_pos;
+    }
 
-        static_assert( C == -1 || C == static_cast<int>(N), "row-wise comparison only possible if tuple size matches column number" );
+    /// @brief tokenizes the next row and calls cell_fn(std::string_view cell, bool escaped)
+    /// for each of its cells. If escaped is true, the cell contains doubled quotes and
+    /// must be passed to unescape() to get its actual content.
+    /// @return false, if there was no row left in the buffer
+    template<class cell_fn_t>
+    bool next_row(cell_fn_t &&cell_fn)
+    {
+        skip_comments();
 
-        if( std::count(m_col_mask.begin(),m_col_mask.end(),true) != N )
-            throw std::runtime_error(
-                fmt::format("{}: row-wise comparison only possible if tuple size matches column number",__func__)
-            );
+        if( m_pos == m_end )
+            return false;
 
-        auto new_row_mask = m_row_mask;
+        const char *p = m_pos;
 
-        // cannot use row_iterable, because we need to stay in sync with the mask
-        for(std::size_t i=0ul; i<new_row_mask.size(); ++i)
+        while( true )
         {
-            if( new_row_mask[i] == true )
+            // state: start of a cell, leading whitespaces are skipped
+            if constexpr( dialect_t::trim )
+                while( p != m_end && classify(*p) == char_class::space )
+                    ++p;
+
+            if( quote_char != '\0' && p != m_end && classify(*p) == char_class::quote )
             {
-                auto array = row_as_str_array<N>(m_loader->data()[i]);
+                // state: quoted cell, runs until a quote which is not followed by another one
+                const char *begin = ++p;
+                bool escaped = false;
+
+                while( (p = find_next<true>(p)) != m_end && p + 1 != m_end && p[1] == quote_char )
+                {
+                    escaped = true;
+                    p += 2;
+                }
+
+                cell_fn(std::string_view(begin, static_cast<std::size_t>(p - begin)), escaped);
 
-                if( !compare_tuple_and_string_array(pred, tuple, array, std::make_index_sequence<N> {}) )
-                    new_row_mask[i] = false;
+                // state: after the closing quote, everything until the next delimiter is ignored
+                if( p != m_end )
+                    p = find_next<false>(p + 1);
             }
-        }
+            else
+            {
+                // state: unquoted cell, runs until the next delimiter or newline
+                const char *begin = p;
+                p = find_next<false>(p);
 
-        return dataframe<loader_t, static_cast<int>(N)>(m_loader, new_row_mask, m_col_mask);
-    }
+                // trailing whitespaces are trimmed, without trimming only the \r of a \r\n
+                const char *last = p;
+                if constexpr( dialect_t::trim )
+                {
+                    while( last != begin && classify(last[-1]) == char_class::space )
+                        --last;
+                }
+                else
+                {
+                    if( last != begin && last[-1] == '\r' && (p == m_end || *p == '\n') )
+                        --last;
+                }
 
-    /// @brief helper-function, which extracts a column as a std::vector of strings
-    auto col_as_str_vector(std::size_t idx)
-    {
-        if( idx > m_col_mask.size() || m_col_mask[idx] == false )
-            throw std::runtime_error(std::string(__func__) + "col_as_vector: requested invalid column");
+                cell_fn(std::string_view(begin, static_cast<std::size_t>(last - begin)), false);
+            }
 
-        std::vector<std::string> col;
-        col.reserve(rows());
+            // state: end of cell, either continue with the next cell or finish the row
+            if( p == m_end )
+            {
+                m_pos = p;
+                return true;
+            }
 
-        for(const auto &row : row_iterable())
-            col.push_back(row[idx]);
+            if( classify(*p) == char_class::newline )
+            {
+                m_pos = p + 1;
+                return true;
+            }
 
-        return col;
+            ++p;
+        }
     }
 
-    /// @brief helper-function, which converts a std::vector of strings to a std::array
-    template<std::size_t N>
-    auto row_as_str_array(const std::vector<std::string> &row) const
+    /// @brief replaces doubled quotes in a cell by single ones
+    static std::string unescape(std::string_view cell)
     {
-        std::array<std::string, N> array;
-        auto array_it = array.begin();
+        std::string result;
+        result.reserve(cell.size());
 
-        for(const auto &cell : col_iterable(row) )
+        for(std::size_t i=0ul; i<cell.size(); ++i)
         {
-            *array_it = cell;
-            ++array_it;
+            result.push_back(cell[i]);
+
+            if( cell[i] == quote_char && i + 1 < cell.size() && cell[i+1] == quote_char )
+                ++i;
         }
 
-        return array;
+        return result;
     }
 
-    /// @brief helper-function, which "extracts" a row as a std::vector of strings
-    auto row_as_str_vector(std::size_t idx)
+    /// @brief reads the header row. For dialects without header, the columns are named
+    /// 0, 1, ... after the number of cells of the first row, which is not consumed.
+    std::vector<std::string> read_header()
     {
-        if( idx > m_row_mask.size() || m_row_mask[idx] == false )
-            throw std::runtime_error(std::string(__func__) + "row_as_vector: requested invalid column");
+        std::vector<std::string> header;
 
-        return m_loader->data()[idx];
-    }
+        if constexpr( dialect_t::header )
+        {
+            next_row([&](auto cell, bool escaped) {
+                header.push_back(escaped ? unescape(cell) : std::string(cell));
+            });
+        }
+        else
+        {
+            auto peek = *this;
+            peek.next_row([&](auto, bool) {
+                header.push_back(std::to_string(header.size()));
+            });
 
-public:
-    /// @brief returns the header of the csv-file
-    const auto &header() const
-    {
-        return m_loader->header();
-    }
+            skip_comments();
+        }
 
-    /// @brief returns the number of active rows
-    auto rows() const
-    {
-        return std::count(m_row_mask.begin(), m_row_mask.end(), true);
+        return header;
     }
+};
 
-    /// @brief returns the number of active columns
-    auto cols() const
-    {
-        return std::count(m_col_mask.begin(), m_col_mask.end(), true);
-    }
+/// @brief tokenizer of the default dialect: comma-separated, quoted with ", trimmed, with header
+using tokenizer = basic_tokenizer<dialect<>>;
 
-    /// @brief returns a row-iterable, which can be used in a range-based for-loop
-    auto row_iterable() const
-    {
-        return masked_iterable(m_loader->data(), m_row_mask );
-    }
+/// @brief memory layout of a caller-provided buffer for dataframe::export_into
+enum class storage_order { row_major, col_major };
 
-    /// @brief returns a column-iterable, which can be used in a range-based for-loop
-    auto col_iterable(const std::vector<std::string> &row) const
+/// @brief types of the typed column storage of the columnar_loader. The order corresponds
+/// to the alternatives of columnar_loader::column_data.
+enum class column_type { int64, float64, boolean, string, category };
+
+/// @brief options for loading a csv-file. Usually not filled directly, but composed
+/// from option tags like mcsv::parallel passed to read_csv
+struct load_options
+{
+    /// @brief number of threads used for tokenizing
+    std::size_t threads = 1;
+
+    /// @brief fixed types for columns of the columnar_loader, the others are inferred
+    std::map<std::string, column_type> column_types;
+
+    /// @brief names of the columns, which are loaded (in this order). All columns if empty.
+    std::vector<std::string> columns;
+
+    /// @brief cache the columnar_loader in a binary snapshot file next to the csv-file
+    bool snapshot = false;
+
+    /// @brief path of the snapshot file, path of the csv-file + ".mcsv" if empty
+    std::filesystem::path snapshot_path;
+
+    /// @brief chunks smaller than that are not worth an own thread
+    static constexpr std::size_t min_chunk_size = 1ul << 20;
+
+    /// @brief number of chunks, in which a buffer of the given size is split for tokenizing
+    std::size_t chunks(std::size_t size) const
     {
-        return masked_iterable(row, m_col_mask);
+        return std::clamp(size / min_chunk_size, std::size_t{1}, std::max(threads, std::size_t{1}));
+    }
+
+    /// @brief value in the result of project() for columns, which are not loaded
+    static constexpr std::size_t skip = std::numeric_limits<std::size_t>::max();
+
+    /// @brief restricts the header of the file to the selected columns
+    /// @param header header of the file, replaced by the header of the loaded columns
+    /// @return for each column of the file its index in the new header, or skip
+    std::vector<std::size_t> project(std::vector<std::string> &header) const
+    {
+        std::vector<std::size_t> slots(header.size());
+
+        if( columns.empty() )
+        {
+            std::iota(slots.begin(), slots.end(), std::size_t{0});
+            return slots;
+        }
+
+        std::fill(slots.begin(), slots.end(), skip);
+
+        for(std::size_t i=0ul; i<columns.size(); ++i)
+        {
+            const auto found = std::find(header.begin(), header.end(), columns[i]);
+
+            if( found == header.end() )
+                throw std::runtime_error(fmt::format("{}: csv-file has no column '{}'", __func__, columns[i]));
+
+            if( std::find(found + 1, header.end(), columns[i]) != header.end() )
+                throw std::runtime_error("csv-file contains multiple columns with the same name!");
+
+            auto &slot = slots[static_cast<std::size_t>(found - header.begin())];
+
+            if( slot != skip )
+                throw std::runtime_error(fmt::format("{}: column '{}' is selected twice", __func__, columns[i]));
+
+            slot = i;
+        }
+
+        header = columns;
+        return slots;
+    }
+};
+
+/// @brief option tag, which enables the parallel loading of a csv-file, e.g.
+/// read_csv(path, mcsv::parallel{8}), or the parallel export, e.g. cols_to_vectors<int>(mcsv::parallel{8})
+struct parallel
+{
+    std::size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    void apply(load_options &options) const
+    {
+        options.threads = threads;
+    }
+};
+
+/// @brief option tag, which fixes the type of columns for the columnar_loader,
+/// e.g. read_csv_columnar(path, mcsv::column_types{{"id", mcsv::column_type::int64}})
+struct column_types
+{
+    std::map<std::string, column_type> types;
+
+    column_types(std::initializer_list<std::pair<const std::string, column_type>> list) :
+        types(list) {}
+
+    void apply(load_options &options) const
+    {
+        for(const auto &[name, type] : types)
+            options.column_types[name] = type;
+    }
+};
+
+/// @brief option tag, which restricts loading to some columns, e.g. read_csv(path, mcsv::columns{"a", "b"}).
+/// The cells of the other columns are skipped by the tokenizer and never stored.
+struct columns
+{
+    std::vector<std::string> names;
+
+    columns(std::initializer_list<std::string> list) :
+        names(list) {}
+
+    void apply(load_options &options) const
+    {
+        options.columns = names;
+    }
+};
+
+/// @brief option tag, which caches the typed columns of the columnar_loader in a binary snapshot
+/// file, e.g. read_csv_columnar(path, mcsv::snapshot{}). The snapshot is written after the first
+/// parse and mapped instead of parsing the csv-file later, as long as it is not stale. The
+/// numeric columns are views on the mapping, so the snapshot must not be modified in place
+/// while a loader uses it (a new snapshot replaces the file, which is fine).
+struct snapshot
+{
+    /// @brief path of the snapshot file, path of the csv-file + ".mcsv" if empty
+    std::filesystem::path path;
+
+    void apply(load_options &options) const
+    {
+        options.snapshot = true;
+        options.snapshot_path = path;
+    }
+};
+
+/// @brief combines several option tags to a load_options object
+template<class... options_t>
+auto make_load_options(const options_t &... options)
+{
+    load_options result;
+    (options.apply(result), ...);
+    return result;
+}
+
+/// @brief counters and timings of the loading and of the queries on a loader. They are only
+/// recorded, if MCSV_ENABLE_STATS is defined before including mcsv.hpp, otherwise all are 0.
+struct stats
+{
+    std::uint64_t bytes_read = 0;
+    std::uint64_t rows_parsed = 0;
+    std::uint64_t cells_parsed = 0;
+
+    /// @brief reallocations of the cell storage while loading
+    std::uint64_t allocations = 0;
+
+    /// @brief cells converted by an extraction
+    std::uint64_t conversions = 0;
+
+    /// @brief rows tested by comparisons and is_in, and rows, which passed them
+    std::uint64_t filtered_rows = 0;
+    std::uint64_t passed_rows = 0;
+
+    /// @brief rows of blocks, whose filter result was known from the zone map (see build_index)
+    std::uint64_t skipped_rows = 0;
+
+    double read_seconds = 0.0;
+    double tokenize_seconds = 0.0;
+    double convert_seconds = 0.0;
+    double filter_seconds = 0.0;
+    double extract_seconds = 0.0;
+};
+
+inline std::ostream &operator<<(std::ostream &os, const stats &s)
+{
+    return os << fmt::format("read {} bytes in {:.3f}s, tokenized {} rows / {} cells in {:.3f}s ({} allocations), "
+                             "converted columns in {:.3f}s, filtered {} rows ({} passed, {} skipped) in {:.3f}s, "
+                             "extracted {} cells in {:.3f}s",
+                             s.bytes_read, s.read_seconds, s.rows_parsed, s.cells_parsed, s.tokenize_seconds,
+                             s.allocations, s.convert_seconds, s.filtered_rows, s.passed_rows, s.skipped_rows, s.filter_seconds,
+                             s.conversions, s.extract_seconds);
+}
+
+/// @brief thread-safe accumulator of the stats of a loader, written by the MCSV_STATS_* macros
+class stats_recorder
+{
+public:
+    enum counter { bytes_read, rows_parsed, cells_parsed, allocations, conversions, filtered_rows, passed_rows, skipped_rows, n_counters };
+    enum phase { read, tokenize, convert, filter, extract, n_phases };
+
+    /// @brief adds the time between construction and destruction to a phase
+    class scoped_timer
+    {
+        stats_recorder *m_recorder;
+        phase m_phase;
+        std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+
+    public:
+        scoped_timer(stats_recorder *recorder, phase p) :
+            m_recorder(recorder), m_phase(p) {}
+
+        scoped_timer(const scoped_timer &) = delete;
+        scoped_timer &operator=(const scoped_timer &) = delete;
+
+        ~scoped_timer()
+        {
+            if( m_recorder )
+                m_recorder->add_time(m_phase, std::chrono::steady_clock::now() - m_start);
+        }
+    };
+
+private:
+    std::array<std::atomic<std::uint64_t>, n_counters> m_counters{};
+    std::array<std::atomic<std::uint64_t>, n_phases> m_nanoseconds{};
+
+public:
+    void add(counter c, std::uint64_t n)
+    {
+        m_counters[c].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void add_time(phase p, std::chrono::steady_clock::duration d)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        m_nanoseconds[p].fetch_add(static_cast<std::uint64_t>(ns), std::memory_order_relaxed);
+    }
+
+    /// @brief adds the counters and timings of another recorder
+    void merge(const stats_recorder &other)
+    {
+        for(std::size_t i=0ul; i<m_counters.size(); ++i)
+            m_counters[i].fetch_add(other.m_counters[i].load(), std::memory_order_relaxed);
+        for(std::size_t i=0ul; i<m_nanoseconds.size(); ++i)
+            m_nanoseconds[i].fetch_add(other.m_nanoseconds[i].load(), std::memory_order_relaxed);
+    }
+
+    /// @brief returns the current values
+    stats snapshot() const
+    {
+        const auto seconds = [&](phase p) { return static_cast<double>(m_nanoseconds[p].load()) * 1e-9; };
+
+        stats s;
+        s.bytes_read = m_counters[bytes_read].load();
+        s.rows_parsed = m_counters[rows_parsed].load();
+        s.cells_parsed = m_counters[cells_parsed].load();
+        s.allocations = m_counters[allocations].load();
+        s.conversions = m_counters[conversions].load();
+        s.filtered_rows = m_counters[filtered_rows].load();
+        s.passed_rows = m_counters[passed_rows].load();
+        s.skipped_rows = m_counters[skipped_rows].load();
+        s.read_seconds = seconds(read);
+        s.tokenize_seconds = seconds(tokenize);
+        s.convert_seconds = seconds(convert);
+        s.filter_seconds = seconds(filter);
+        s.extract_seconds = seconds(extract);
+        return s;
+    }
+};
+
+// Instrumentation of the hot paths, compiled out unless MCSV_ENABLE_STATS is defined.
+// recorder is a stats_recorder pointer, which may be nullptr. With MCSV_ENABLE_TRACY and
+// the Tracy client available, each timed phase is also a Tracy zone.
+#if defined(MCSV_ENABLE_TRACY) && __has_include(<tracy/Tracy.hpp>)
+#define MCSV_TRACE_ZONE(name) ZoneScopedN(name)
+#else
+#define MCSV_TRACE_ZONE(name) ((void)0)
+#endif
+
+#ifdef MCSV_ENABLE_STATS
+#define MCSV_STATS_ADD(recorder, counter, n) \
+    do { if( auto *mcsv_recorder_ = (recorder) ) mcsv_recorder_->add(::mcsv::stats_recorder::counter, (n)); } while(false)
+#define MCSV_STATS_PHASE(recorder, phase) \
+    MCSV_TRACE_ZONE("mcsv " #phase); ::mcsv::stats_recorder::scoped_timer mcsv_timer_##phase((recorder), ::mcsv::stats_recorder::phase)
+#else
+#define MCSV_STATS_ADD(recorder, counter, n) ((void)0)
+#define MCSV_STATS_PHASE(recorder, phase) MCSV_TRACE_ZONE("mcsv " #phase)
+#endif
+
+class zone_map;
+
+/// @brief the zone map of a loader, which is recorded by the loader (see zones()), so it is
+/// shared by all dataframes over it. Set by dataframe::build_index.
+class zone_map_slot
+{
+    std::shared_ptr<const zone_map> m_zones;
+
+public:
+    std::shared_ptr<const zone_map> get() const
+    {
+        return std::atomic_load(&m_zones);
+    }
+
+    void set(std::shared_ptr<const zone_map> zones)
+    {
+        std::atomic_store(&m_zones, std::move(zones));
+    }
+};
+
+/// @brief runs fn(i) for i = 0 ... n-1, each in an own thread, and rethrows the first exception
+template<class fn_t>
+void run_parallel(std::size_t n, const fn_t &fn)
+{
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(n);
+
+    for(std::size_t i=0ul; i<n; ++i)
+        threads.emplace_back([&, i]() {
+            try { fn(i); }
+            catch(...) { errors[i] = std::current_exception(); }
+        });
+
+    for(auto &thread : threads)
+        thread.join();
+
+    for(const auto &error : errors)
+        if( error )
+            std::rethrow_exception(error);
+}
+
+/// @brief Tokenizes the rows of a buffer in parallel. The buffer is split into byte ranges,
+/// each range is resynchronized to the first newline which is not inside of a quoted cell
+/// (determined by the parity of the quotes before it) and the ranges are tokenized concurrently.
+/// Afterwards it is checked, that each range ended exactly where the next one started. If not
+/// (only possible with malformed quoting), the next range is tokenized again from the correct
+/// position, so the result is always the same as with sequential tokenizing.
+/// @param buffer the buffer, the first row must start at its beginning
+/// @param chunks number of ranges, each of them is processed by an own thread
+/// @param chunk_fn called as chunk_fn(std::size_t chunk, basic_tokenizer<dialect_t> &tok, const char *stop),
+/// must tokenize rows with tok until tok.position() >= stop. Can be called more than once per
+/// chunk, in this case the results of the previous call must be discarded.
+/// @tparam dialect_t the dialect of the buffer
+template<class dialect_t = dialect<>, class chunk_fn_t>
+void parallel_tokenize(std::string_view buffer, std::size_t chunks, const chunk_fn_t &chunk_fn)
+{
+    using tokenizer_t = basic_tokenizer<dialect_t>;
+    constexpr char quote = dialect_t::quote;
+
+    const char *begin = buffer.data();
+    const char *end = buffer.data() + buffer.size();
+
+    chunks = std::max(chunks, std::size_t{1});
+
+    if( chunks == 1 )
+    {
+        tokenizer_t tok(buffer);
+        chunk_fn(0, tok, end);
+        return;
+    }
+
+    const auto for_each_chunk = [&](const auto &fn) {
+        run_parallel(chunks, fn);
+    };
+
+    // nominal byte ranges and the number of quotes inside each of them
+    std::vector<const char *> bounds(chunks + 1);
+    for(std::size_t i=0ul; i<=chunks; ++i)
+        bounds[i] = begin + buffer.size() / chunks * i;
+    bounds[chunks] = end;
+
+    std::vector<std::size_t> quotes(chunks);
+    for_each_chunk([&](std::size_t i) {
+        quotes[i] = quote == '\0' ? 0 : static_cast<std::size_t>(std::count(bounds[i], bounds[i+1], quote));
+    });
+
+    // resynchronize each range on the first newline outside of quotes
+    std::vector<const char *> starts(chunks + 1);
+    starts[0] = begin;
+    starts[chunks] = end;
+
+    bool in_quotes = false;
+    for(std::size_t i=1ul; i<chunks; ++i)
+    {
+        in_quotes ^= (quotes[i-1] % 2 == 1);
+
+        bool quoted = in_quotes;
+        const char *p = bounds[i];
+
+        for(; p != end && (quoted || *p != '\n'); ++p)
+            if( quote != '\0' && *p == quote )
+                quoted = !quoted;
+
+        starts[i] = std::max(starts[i-1], p == end ? end : p + 1);
+    }
+
+    // tokenize all ranges concurrently
+    std::vector<const char *> stops(chunks);
+    for_each_chunk([&](std::size_t i) {
+        tokenizer_t tok(std::string_view(starts[i], static_cast<std::size_t>(end - starts[i])));
+        chunk_fn(i, tok, starts[i+1]);
+        stops[i] = tok.position();
+    });
+
+    // validate the boundaries, and redo mis-synchronized ranges sequentially
+    for(std::size_t i=1ul; i<chunks; ++i)
+    {
+        if( stops[i-1] == starts[i] )
+            continue;
+
+        starts[i] = stops[i-1];
+        tokenizer_t tok(std::string_view(starts[i], static_cast<std::size_t>(end - starts[i])));
+        chunk_fn(i, tok, std::max(starts[i], starts[i+1]));
+        stops[i] = tok.position();
+    }
+}
+
+/// @brief fast non-cryptographic hash of a byte range, processed 8 bytes at a time
+inline std::uint64_t hash_bytes(std::string_view bytes, std::uint64_t seed = 0)
+{
+    std::uint64_t h = seed ^ (bytes.size() * 0x9e3779b97f4a7c15ull);
+
+    std::size_t i = 0;
+    for(; i + sizeof(std::uint64_t) <= bytes.size(); i += sizeof(std::uint64_t))
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes.data() + i, sizeof(word));
+        h = (h ^ word) * 0xff51afd7ed558ccdull;
+        h ^= h >> 32;
+    }
+
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, bytes.data() + i, bytes.size() - i);
+    h = (h ^ tail) * 0xc4ceb9fe1a85ec53ull;
+
+    return h ^ (h >> 33);
+}
+
+/// @brief compression formats, which are recognized by the first bytes of a file
+enum class compression { none, gzip, zstd };
+
+/// @brief detects the compression of a file from its first bytes (the magic number)
+inline compression detect_compression(std::string_view bytes)
+{
+    if( bytes.substr(0, 2) == std::string_view("\x1f\x8b", 2) )
+        return compression::gzip;
+    if( bytes.substr(0, 4) == std::string_view("\x28\xb5\x2f\xfd", 4) )
+        return compression::zstd;
+
+    return compression::none;
+}
+
+/// @brief Incremental decompression of a gzip or zstd stream. The input can be given in pieces
+/// of any size, concatenated gzip members and zstd frames are decompressed one after another.
+/// The formats are only supported if mcsv is built with zlib or zstd (see MCSV_ENABLE_ZLIB
+/// and MCSV_ENABLE_ZSTD), otherwise the constructor throws.
+class stream_decoder
+{
+    compression m_format;
+    bool m_complete = false;
+
+#ifdef MCSV_ZLIB_SUPPORT
+    z_stream m_zlib{};
+#endif
+#ifdef MCSV_ZSTD_SUPPORT
+    ZSTD_DStream *m_zstd = nullptr;
+#endif
+
+    /// @brief output is appended in steps of this size
+    static constexpr std::size_t step = 1ul << 16;
+
+public:
+    stream_decoder(compression format) :
+        m_format(format)
+    {
+        bool supported = false;
+
+#ifdef MCSV_ZLIB_SUPPORT
+        // 15 + 32: maximum window size and automatic detection of the gzip header
+        if( format == compression::gzip )
+        {
+            if( inflateInit2(&m_zlib, 15 + 32) != Z_OK )
+                throw std::runtime_error(fmt::format("{}: could not initialize zlib", __func__));
+            supported = true;
+        }
+#endif
+#ifdef MCSV_ZSTD_SUPPORT
+        if( format == compression::zstd )
+        {
+            m_zstd = ZSTD_createDStream();
+            if( !m_zstd )
+                throw std::runtime_error(fmt::format("{}: could not initialize zstd", __func__));
+            supported = true;
+        }
+#endif
+
+        if( !supported )
+            throw std::runtime_error(
+                fmt::format("{}: input is {}-compressed, but mcsv is built without {}", __func__,
+                            format == compression::gzip ? "gzip" : "zstd", format == compression::gzip ? "zlib" : "zstd"));
+    }
+
+    stream_decoder(const stream_decoder &) = delete;
+    stream_decoder &operator=(const stream_decoder &) = delete;
+
+    ~stream_decoder()
+    {
+#ifdef MCSV_ZLIB_SUPPORT
+        if( m_format == compression::gzip )
+            inflateEnd(&m_zlib);
+#endif
+#ifdef MCSV_ZSTD_SUPPORT
+        if( m_zstd )
+            ZSTD_freeDStream(m_zstd);
+#endif
+    }
+
+    /// @brief decompresses all of input and appends the result to out
+    void decode(std::string_view input, std::string &out)
+    {
+#ifdef MCSV_ZLIB_SUPPORT
+        if( m_format == compression::gzip )
+        {
+            // zlib counts in uInt, so the input is passed in pieces of at most 1 GiB
+            while( !input.empty() )
+            {
+                const auto piece = input.substr(0, 1ul << 30);
+                input.remove_prefix(piece.size());
+
+                m_zlib.next_in = const_cast<Bytef *>(reinterpret_cast<const Bytef *>(piece.data()));
+                m_zlib.avail_in = static_cast<uInt>(piece.size());
+
+                // decompress until the input is consumed and no output is pending
+                do
+                {
+                    const auto old_size = out.size();
+                    out.resize(old_size + step);
+                    m_zlib.next_out = reinterpret_cast<Bytef *>(out.data() + old_size);
+                    m_zlib.avail_out = static_cast<uInt>(step);
+
+                    const int ret = inflate(&m_zlib, Z_NO_FLUSH);
+                    out.resize(old_size + step - m_zlib.avail_out);
+
+                    if( ret == Z_STREAM_END )
+                    {
+                        m_complete = true;
+
+                        // another gzip member may follow
+                        if( m_zlib.avail_in == 0 )
+                            break;
+                        if( inflateReset(&m_zlib) != Z_OK )
+                            throw std::runtime_error(fmt::format("{}: could not reset zlib", __func__));
+                    }
+                    else if( ret == Z_BUF_ERROR && m_zlib.avail_in == 0 )
+                    {
+                        // no more output is pending
+                        break;
+                    }
+                    else if( ret == Z_OK )
+                    {
+                        m_complete = false;
+                    }
+                    else
+                    {
+                        throw std::runtime_error(fmt::format("{}: invalid gzip data ({})", __func__,
+                                                             m_zlib.msg ? m_zlib.msg : "unknown error"));
+                    }
+                }
+                while( m_zlib.avail_in > 0 || m_zlib.avail_out == 0 );
+            }
+        }
+#endif
+#ifdef MCSV_ZSTD_SUPPORT
+        if( m_format == compression::zstd )
+        {
+            ZSTD_inBuffer in{ input.data(), input.size(), 0 };
+
+            // decompress until the input is consumed and no output is pending
+            while( true )
+            {
+                const auto old_size = out.size();
+                const auto old_pos = in.pos;
+                out.resize(old_size + step);
+                ZSTD_outBuffer buffer{ out.data() + old_size, step, 0 };
+
+                const auto ret = ZSTD_decompressStream(m_zstd, &buffer, &in);
+                out.resize(old_size + buffer.pos);
+
+                if( ZSTD_isError(ret) )
+                    throw std::runtime_error(fmt::format("{}: invalid zstd data ({})", __func__, ZSTD_getErrorName(ret)));
+
+                // 0 means, that a frame is completely decoded and flushed. A call without
+                // progress only returns a hint for the next frame, so it does not count.
+                const bool progress = ( in.pos != old_pos || buffer.pos > 0 );
+                if( progress )
+                    m_complete = ( ret == 0 );
+
+                // if the output buffer is not full, nothing is pending inside of zstd
+                if( in.pos == in.size && ( ret == 0 || buffer.pos < buffer.size || !progress ) )
+                    break;
+            }
+        }
+#endif
+        (void)input;
+        (void)out;
+    }
+
+    /// @brief throws, if the input ended inside of a gzip member or zstd frame
+    void finish() const
+    {
+        if( !m_complete )
+            throw std::runtime_error(fmt::format("{}: compressed input is truncated", __func__));
+    }
+};
+
+#ifdef MCSV_ZSTD_SUPPORT
+/// @brief decompresses a zstd file with several frames in parallel, each thread decompresses
+/// a contiguous range of frames directly into its place in the output
+/// @return the decompressed data, or std::nullopt if there is only one frame or the size of a
+/// frame is not stored in its header
+inline std::optional<std::string> decompress_zstd_frames(std::string_view input, std::size_t threads)
+{
+    std::vector<std::string_view> frames;
+    std::vector<std::size_t> offsets = {0};
+
+    for(auto rest = input; !rest.empty(); )
+    {
+        const auto frame_size = ZSTD_findFrameCompressedSize(rest.data(), rest.size());
+        if( ZSTD_isError(frame_size) )
+            return std::nullopt;
+
+        const auto content_size = ZSTD_getFrameContentSize(rest.data(), frame_size);
+        if( content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size == ZSTD_CONTENTSIZE_ERROR )
+            return std::nullopt;
+
+        frames.push_back(rest.substr(0, frame_size));
+        offsets.push_back(offsets.back() + static_cast<std::size_t>(content_size));
+        rest.remove_prefix(frame_size);
+    }
+
+    if( frames.size() < 2 )
+        return std::nullopt;
+
+    std::string out(offsets.back(), '\0');
+    const auto parts = std::min(threads, frames.size());
+
+    run_parallel(parts, [&](std::size_t part) {
+        const std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> ctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+
+        for(auto f = frames.size() * part / parts; f < frames.size() * (part + 1) / parts; ++f)
+        {
+            const auto size = offsets[f + 1] - offsets[f];
+            const auto ret = ZSTD_decompressDCtx(ctx.get(), out.data() + offsets[f], size, frames[f].data(), frames[f].size());
+
+            if( ZSTD_isError(ret) || ret != size )
+                throw std::runtime_error(fmt::format("{}: invalid zstd frame {}", __func__, f));
+        }
+    });
+
+    return out;
+}
+#endif
+
+/// @brief decompresses a whole buffer
+/// @param threads zstd files with several frames are decompressed with this number of threads
+inline std::string decompress(std::string_view input, compression format, std::size_t threads = 1)
+{
+#ifdef MCSV_ZSTD_SUPPORT
+    if( format == compression::zstd && threads > 1 )
+        if( auto out = decompress_zstd_frames(input, threads) )
+            return std::move(*out);
+#endif
+    (void)threads;
+
+    stream_decoder decoder(format);
+    std::string out;
+
+    // the last 4 bytes of a gzip member are its size modulo 2^32, which is a good guess
+    if( format == compression::gzip && input.size() >= 4 )
+    {
+        std::uint32_t size = 0;
+        std::memcpy(&size, input.data() + input.size() - 4, 4);
+        out.reserve(size);
+    }
+
+    decoder.decode(input, out);
+    decoder.finish();
+    return out;
+}
+
+/// @brief Sequential reader of a file, which is decompressed transparently. Compressed files are
+/// decompressed on a background thread into a bounded queue of blocks, so the decompression
+/// runs in parallel to the processing of the previous blocks.
+class input_stream
+{
+    /// @brief the file and the blocks decompressed by the background thread
+    struct source
+    {
+        std::ifstream file;
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<std::string> blocks;
+        bool finished = false;
+        bool stop = false;
+        std::exception_ptr error;
+
+        /// @brief number of blocks, which are decompressed in advance
+        static constexpr std::size_t capacity = 4;
+
+        /// @brief reads and decompresses the file, runs on the background thread
+        void decompress_blocks(compression format, std::size_t block_size)
+        {
+            try
+            {
+                stream_decoder decoder(format);
+                std::string input(block_size, '\0');
+
+                while( file )
+                {
+                    file.read(input.data(), static_cast<std::streamsize>(block_size));
+
+                    // the last read is empty, if the file size is a multiple of block_size
+                    if( file.gcount() == 0 )
+                        break;
+
+                    std::string out;
+                    out.reserve(4 * block_size);
+                    decoder.decode(std::string_view(input.data(), static_cast<std::size_t>(file.gcount())), out);
+
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&]() { return stop || blocks.size() < capacity; });
+
+                    if( stop )
+                        return;
+
+                    blocks.push_back(std::move(out));
+                    lock.unlock();
+                    changed.notify_all();
+                }
+
+                decoder.finish();
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished = true;
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::unique_ptr<source> m_source;
+    compression m_format = compression::none;
+    std::thread m_worker;
+
+    // the block, which is currently read from
+    std::string m_block;
+    std::size_t m_pos = 0;
+
+    /// @brief takes the next block from the queue
+    /// @return false at the end of the file
+    bool next_block()
+    {
+        auto &src = *m_source;
+        std::unique_lock<std::mutex> lock(src.mutex);
+        src.changed.wait(lock, [&]() { return src.finished || !src.blocks.empty(); });
+
+        if( src.blocks.empty() )
+        {
+            if( src.error )
+                std::rethrow_exception(src.error);
+            return false;
+        }
+
+        m_block = std::move(src.blocks.front());
+        src.blocks.pop_front();
+        m_pos = 0;
+
+        lock.unlock();
+        src.changed.notify_all();
+        return true;
+    }
+
+public:
+    /// @brief opens the file and starts the decompression, if it is compressed
+    /// @param block_size number of compressed bytes, which are read from the file at once
+    input_stream(const std::filesystem::path &path, std::size_t block_size = 1ul << 20) :
+        m_source(std::make_unique<source>())
+    {
+        auto &file = m_source->file;
+        file.open(path, std::ios::binary);
+
+        if( !file )
+            throw std::runtime_error("could not open '" + path.string() + "'!");
+
+        std::array<char, 4> magic{};
+        file.read(magic.data(), magic.size());
+        m_format = detect_compression(std::string_view(magic.data(), static_cast<std::size_t>(file.gcount())));
+
+        file.clear();
+        file.seekg(0);
+
+        if( m_format != compression::none )
+            m_worker = std::thread([src = m_source.get(), format = m_format, block_size]() {
+                src->decompress_blocks(format, block_size);
+            });
+    }
+
+    input_stream(input_stream &&) = default;
+    input_stream &operator=(input_stream &&) = delete;
+
+    ~input_stream()
+    {
+        if( m_worker.joinable() )
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_source->mutex);
+                m_source->stop = true;
+            }
+            m_source->changed.notify_all();
+            m_worker.join();
+        }
+    }
+
+    /// @brief compression of the file
+    auto format() const
+    {
+        return m_format;
+    }
+
+    /// @brief reads up to n decompressed bytes
+    /// @return the number of bytes read, less than n only at the end of the file
+    std::size_t read(char *out, std::size_t n)
+    {
+        if( m_format == compression::none )
+        {
+            m_source->file.read(out, static_cast<std::streamsize>(n));
+            return static_cast<std::size_t>(m_source->file.gcount());
+        }
+
+        std::size_t copied = 0;
+        while( copied < n && (m_pos < m_block.size() || next_block()) )
+        {
+            const auto k = std::min(n - copied, m_block.size() - m_pos);
+            std::memcpy(out + copied, m_block.data() + m_pos, k);
+            m_pos += k;
+            copied += k;
+        }
+
+        return copied;
+    }
+};
+
+/// @brief RAII-wrapper around a read-only memory mapping of a whole file. If mmap is
+/// not available on the platform, the file is read into a buffer instead.
+class mapped_file
+{
+    const char *m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_mapped = false;
+
+    // content of the file, if it is not mapped or if it is decompressed
+    std::string m_buffer;
+
+    void unmap()
+    {
+#ifdef MCSV_MMAP_SUPPORT
+        if( m_mapped )
+            ::munmap(const_cast<char *>(m_data), m_size);
+#endif
+        m_mapped = false;
+    }
+
+public:
+    /// @brief maps the file. Compressed files (see compression) are decompressed into memory.
+    /// @param threads zstd files with several frames are decompressed with this number of threads
+    mapped_file(const std::filesystem::path &path, std::size_t threads = 1)
+    {
+        if( !std::filesystem::exists(path) )
+            throw std::runtime_error("path '" + path.string() + "' does not exist!");
+
+        m_size = std::filesystem::file_size(path);
+
+#ifdef MCSV_MMAP_SUPPORT
+        // mmap with size 0 is not allowed, an empty file just stays unmapped
+        if( m_size == 0 )
+            return;
+
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if( fd == -1 )
+            throw std::runtime_error("could not open '" + path.string() + "'!");
+
+        void *ptr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if( ptr == MAP_FAILED )
+            throw std::runtime_error("could not mmap '" + path.string() + "'!");
+
+        ::madvise(ptr, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char *>(ptr);
+        m_mapped = true;
+#else
+        std::ifstream file(path, std::ios::binary);
+        m_buffer.resize(m_size);
+        file.read(m_buffer.data(), static_cast<std::streamsize>(m_size));
+        m_data = m_buffer.data();
+#endif
+
+        if( const auto format = detect_compression(view()); format != compression::none )
+        {
+            auto decompressed = decompress(view(), format, threads);
+            unmap();
+
+            m_buffer = std::move(decompressed);
+            m_data = m_buffer.data();
+            m_size = m_buffer.size();
+        }
+    }
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    ~mapped_file()
+    {
+        unmap();
+    }
+
+    /// @brief returns the content of the file
+    std::string_view view() const
+    {
+        return std::string_view(m_data, m_size);
+    }
+};
+
+/// @brief read-only view on a single row, whose cells are stored as a contiguous
+/// range of std::string_view somewhere else (e.g. in a default_loader or mmap_loader)
+class row_view
+{
+    const std::string_view *m_begin = nullptr;
+    std::size_t m_size = 0;
+
+public:
+    using value_type = std::string_view;
+    using const_iterator = const std::string_view *;
+
+    row_view() = default;
+    row_view(const std::string_view *begin, std::size_t size) :
+        m_begin(begin), m_size(size) {}
+
+    auto begin() const { return m_begin; }
+    auto end() const { return m_begin + m_size; }
+    auto size() const { return m_size; }
+
+    const auto &operator[](std::size_t i) const { return m_begin[i]; }
+};
+
+/// @brief read-only view on a table of std::string_view with a fixed number of columns.
+/// Behaves like a container of row_view objects.
+class table_view
+{
+    const std::string_view *m_cells = nullptr;
+    std::size_t m_rows = 0;
+    std::size_t m_cols = 0;
+
+public:
+    /// @brief iterator over the rows, dereferences to a row_view
+    class const_iterator
+    {
+        const std::string_view *m_ptr;
+        std::size_t m_cols;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = row_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = row_view;
+
+        const_iterator(const std::string_view *ptr, std::size_t cols) :
+            m_ptr(ptr), m_cols(cols) {}
+
+        auto operator*() const { return row_view(m_ptr, m_cols); }
+        auto &operator++() { m_ptr += m_cols; return *this; }
+        bool operator==(const const_iterator &other) const { return m_ptr == other.m_ptr; }
+        bool operator!=(const const_iterator &other) const { return m_ptr != other.m_ptr; }
+    };
+
+    using value_type = row_view;
+    using iterator = const_iterator;
+
+    table_view() = default;
+    table_view(const std::string_view *cells, std::size_t rows, std::size_t cols) :
+        m_cells(cells), m_rows(rows), m_cols(cols) {}
+
+    auto begin() const { return const_iterator(m_cells, m_cols); }
+    auto end() const { return const_iterator(m_cells + m_rows * m_cols, m_cols); }
+    auto size() const { return m_rows; }
+
+    auto operator[](std::size_t row) const { return row_view(m_cells + row * m_cols, m_cols); }
+};
+
+/// @brief Monotonic storage for the cells of a table. The bytes of all cells are appended to
+/// one buffer and each cell is recorded by its end offset in one contiguous table, so filling
+/// the arena needs no allocation per cell and releasing it only two deallocations. Once it is
+/// filled, the offsets can be exchanged for views on the cells (see release_views).
+class cell_arena
+{
+    // the buffer grows geometrically, only its first m_used bytes are filled
+    std::string m_bytes;
+    std::size_t m_used = 0;
+    std::vector<std::size_t> m_ends;
+    std::size_t m_allocations = 0;
+
+    /// @brief returns a pointer to n free bytes at the end of the buffer
+    char *grow(std::size_t n)
+    {
+        if( m_used + n > m_bytes.size() )
+        {
+            m_bytes.resize(std::max(2 * m_bytes.size(), m_used + n));
+            ++m_allocations;
+        }
+
+        return m_bytes.data() + m_used;
+    }
+
+public:
+    /// @brief reserves the byte buffer, e.g. with the size of the raw cells as upper bound
+    void reserve(std::size_t bytes)
+    {
+        grow(bytes);
+    }
+
+    /// @brief appends a cell, escaped cells are unescaped while copying
+    /// @param quote the quote character of the dialect
+    void push(std::string_view cell, bool escaped = false, char quote = '"')
+    {
+        char *out = grow(cell.size());
+
+        if( !escaped )
+        {
+            std::memcpy(out, cell.data(), cell.size());
+            m_used += cell.size();
+        }
+        else
+        {
+            char *p = out;
+
+            for(std::size_t i=0ul; i<cell.size(); ++i)
+            {
+                *p++ = cell[i];
+
+                if( cell[i] == quote && i + 1 < cell.size() && cell[i+1] == quote )
+                    ++i;
+            }
+
+            m_used += static_cast<std::size_t>(p - out);
+        }
+
+        m_ends.push_back(m_used);
+    }
+
+    /// @brief appends views on all cells to views and releases the offset table, so only the
+    /// bytes remain. The views stay valid as long as the arena is neither modified nor moved.
+    void release_views(std::vector<std::string_view> &views)
+    {
+        for(std::size_t i=0ul; i<m_ends.size(); ++i)
+            views.push_back((*this)[i]);
+
+        std::vector<std::size_t>().swap(m_ends);
+    }
+
+    /// @brief number of reallocations of the byte buffer
+    std::size_t allocations() const
+    {
+        return m_allocations;
+    }
+
+    /// @brief number of cells
+    std::size_t size() const
+    {
+        return m_ends.size();
+    }
+
+    /// @brief returns a view on a cell, which is valid as long as the arena is not modified
+    std::string_view operator[](std::size_t i) const
+    {
+        const auto begin = i == 0 ? std::size_t{0} : m_ends[i-1];
+        return std::string_view(m_bytes.data() + begin, m_ends[i] - begin);
+    }
+};
+
+/// @brief Underlying data storage class. At the start loads the whole data into memory.
+/// The cells are copied into one cell_arena per chunk of the file, which are indexed by a
+/// single table of views. data() returns a table_view of row_view objects on it.
+/// For files larger than the memory, see csv_reader.
+class default_loader
+{
+    // the segments are never moved after the views on their cells have been taken
+    std::vector<cell_arena> m_segments;
+    std::vector<std::string_view> m_views;
+    table_view m_table;
+
+    std::vector<std::string> m_header;
+
+    std::map<std::string, std::size_t> m_header_map;
+
+    mutable stats_recorder m_stats;
+    mutable zone_map_slot m_zones;
+
+    /// @brief ensures, that the header does not contain duplicates
+    static void throw_if_duplicates(std::vector<std::string> ref_header)
+    {
+        std::sort(ref_header.begin(), ref_header.end());
+
+        auto test_header = ref_header;
+        std::unique(test_header.begin(), test_header.end());
+
+        if( test_header != ref_header )
+            throw std::runtime_error("csv-file contains multiple columns with the same name!");
+    }
+
+    /// @brief checks the header and relates its column names to the indices
+    void init_header_map()
+    {
+        throw_if_duplicates(m_header);
+        for(std::size_t i=0ul; i<m_header.size(); ++i)
+            m_header_map[ m_header[i] ] = i;
+    }
+
+    /// @brief builds the table of views, after all cells have been stored in the segments.
+    /// The offsets of each segment are released right after its views are taken.
+    void init_table()
+    {
+        const auto cols = m_header.size();
+
+        std::size_t cells = 0;
+        for(const auto &segment : m_segments)
+            cells += segment.size();
+
+        m_views.reserve(cells);
+        for(auto &segment : m_segments)
+            segment.release_views(m_views);
+
+        m_table = table_view(m_views.data(), cols == 0 ? 0 : m_views.size() / cols, cols);
+    }
+
+public:
+    /// @brief constructs the loader from already tokenized cells, e.g. a batch of the csv_reader.
+    /// The cells are stored row by row, each row must have as many cells as the header.
+    default_loader(std::vector<std::string> header, cell_arena cells) :
+        m_header(std::move(header))
+    {
+        m_segments.push_back(std::move(cells));
+
+        init_header_map();
+        init_table();
+    }
+
+    /// @brief constructs the loader from rows of strings.
+    /// All rows must have as many cells as the header.
+    default_loader(std::vector<std::string> header, const std::vector<std::vector<std::string>> &data) :
+        m_header(std::move(header))
+    {
+        auto &cells = m_segments.emplace_back();
+
+        for(const auto &row : data)
+            for(const auto &cell : row)
+                cells.push(cell);
+
+        init_header_map();
+        init_table();
+    }
+
+    /// @brief constructs the loader, and loads all data to memory
+    default_loader(std::filesystem::path path, const load_options &options = {}) :
+        default_loader(path, options, dialect<>{})
+    {
+    }
+
+    /// @brief constructs the loader for a file of the given dialect, and loads all data to memory
+    template<class dialect_t>
+    default_loader(std::filesystem::path path, const load_options &options, dialect_t)
+    {
+        std::optional<mapped_file> mapping;
+        {
+            MCSV_STATS_PHASE(&m_stats, read);
+            mapping.emplace(path, options.threads);
+        }
+
+        const auto &file = *mapping;
+        MCSV_STATS_ADD(&m_stats, bytes_read, file.view().size());
+        MCSV_STATS_PHASE(&m_stats, tokenize);
+
+        basic_tokenizer<dialect_t> tok(file.view());
+
+        m_header = tok.read_header();
+
+        const auto slots = options.project(m_header);
+        init_header_map();
+
+        // body, rows with less cells are filled with empty strings, longer rows are cut
+        const auto cols = m_header.size();
+        const auto body = file.view().substr(static_cast<std::size_t>(tok.position() - file.view().data()));
+
+        std::vector<cell_arena> chunks(options.chunks(body.size()));
+
+        parallel_tokenize<dialect_t>(body, chunks.size(), [&](std::size_t i, auto &chunk_tok, const char *stop) {
+            auto &cells = chunks[i];
+            cells = cell_arena{};
+
+            // the cells take at most as many bytes as the chunk
+            cells.reserve(static_cast<std::size_t>(stop - chunk_tok.position()));
+
+            // without projection, the cells are stored in the order of the file
+            if( options.columns.empty() )
+            {
+                while( chunk_tok.position() < stop )
+                {
+                    std::size_t n = 0;
+
+                    chunk_tok.next_row([&](auto cell, bool escaped) {
+                        if( n++ < cols )
+                            cells.push(cell, escaped, dialect_t::quote);
+                    });
+
+                    for(; n < cols; ++n)
+                        cells.push({});
+                }
+
+                return;
+            }
+
+            // views on the cells of the current row, in the order of the loaded columns.
+            // Cells of columns, which are not loaded, are not copied.
+            std::vector<std::pair<std::string_view, bool>> row(cols);
+
+            while( chunk_tok.position() < stop )
+            {
+                std::fill(row.begin(), row.end(), std::pair<std::string_view, bool>{});
+                std::size_t n = 0;
+
+                chunk_tok.next_row([&](auto cell, bool escaped) {
+                    const auto slot = n < slots.size() ? slots[n] : load_options::skip;
+                    ++n;
+
+                    if( slot != load_options::skip )
+                        row[slot] = {cell, escaped};
+                });
+
+                for(const auto &[cell, escaped] : row)
+                    cells.push(cell, escaped, dialect_t::quote);
+            }
+        });
+
+        // the chunks are kept as segments in order, their bytes are not copied again
+        m_segments = std::move(chunks);
+        init_table();
+
+        MCSV_STATS_ADD(&m_stats, rows_parsed, m_table.size());
+        MCSV_STATS_ADD(&m_stats, cells_parsed, m_views.size());
+        MCSV_STATS_ADD(&m_stats, allocations, std::accumulate(m_segments.begin(), m_segments.end(), std::size_t{0},
+                                                             [](std::size_t n, const cell_arena &segment) { return n + segment.allocations(); }));
+    }
+
+    default_loader(const default_loader &) = delete;
+    default_loader &operator=(const default_loader &) = delete;
+
+    /// @brief getter for the statistics of the loading and of the queries
+    stats_recorder &recorder() const
+    {
+        return m_stats;
+    }
+
+    /// @brief getter for the zone map, which is set by dataframe::build_index
+    zone_map_slot &zones() const
+    {
+        return m_zones;
+    }
+
+    /// @brief getter for the body of the csv-file
+    const auto &data() const
+    {
+        return m_table;
+    }
+
+    /// @brief getter for the header of the csv-file
+    const auto &header() const
+    {
+        return m_header;
+    }
+
+    /// @brief getter for a map, which relates indices and column-headers
+    const auto &header_map() const
+    {
+        return m_header_map;
+    }
+
+    /// @brief access a specific cell in the csv file
+    const auto &at(std::size_t row, std::size_t col) const
+    {
+        if( m_table.size() <= row )
+            throw std::runtime_error(
+                fmt::format("{}: csv file has only {} rows, but row {} has been requested",
+                            __func__, m_table.size(), row));
+
+        if( m_header.size() <= col )
+            throw std::runtime_error(
+                fmt::format("{}: csv file has only {} cols, but col {} has been requested",
+                            __func__, m_header.size(), col));
+
+        return m_views[row * m_header.size() + col];
+    }
+};
+
+/// @brief Alternative data storage class, which maps the file into memory and keeps only
+/// a std::string_view for each cell. Memory consumption therefore scales with the file size
+/// and not with the number of cells. Follows the same interface as the default_loader, but
+/// the cells are not copied, so the file must not be modified while the loader exists.
+class mmap_loader
+{
+    mapped_file m_file;
+
+    std::vector<std::string_view> m_cells;
+    std::vector<std::string> m_header;
+    std::map<std::string, std::size_t> m_header_map;
+
+    /// @brief cells with escaped quotes cannot be viewed in the mapping, so their unescaped
+    /// content is stored here (one std::deque per chunk, which does not invalidate references on growth)
+    std::vector<std::deque<std::string>> m_unescaped;
+
+    table_view m_table;
+
+    mutable stats_recorder m_stats;
+    mutable zone_map_slot m_zones;
+
+    /// @brief returns a view on the cell content, unescapes the cell if necessary
+    template<class dialect_t>
+    static std::string_view store_cell(std::string_view cell, bool escaped, std::deque<std::string> &unescaped)
+    {
+        if( !escaped )
+            return cell;
+
+        return unescaped.emplace_back(basic_tokenizer<dialect_t>::unescape(cell));
+    }
+
+public:
+    /// @brief maps the file and builds the cell index
+    mmap_loader(std::filesystem::path path, const load_options &options = {}) :
+        mmap_loader(path, options, dialect<>{})
+    {
+    }
+
+    /// @brief maps a file of the given dialect and builds the cell index
+    template<class dialect_t>
+    mmap_loader(std::filesystem::path path, const load_options &options, dialect_t) :
+        m_file(path, options.threads)
+    {
+        const auto buffer = m_file.view();
+        MCSV_STATS_ADD(&m_stats, bytes_read, buffer.size());
+        MCSV_STATS_PHASE(&m_stats, tokenize);
+
+        basic_tokenizer<dialect_t> tok(buffer);
+
+        m_header = tok.read_header();
+
+        const auto slots = options.project(m_header);
+
+        for(std::size_t i=0ul; i<m_header.size(); ++i)
+            if( !m_header_map.emplace(m_header[i], i).second )
+                throw std::runtime_error("csv-file contains multiple columns with the same name!");
+
+        // body, each row gets exactly m_header.size() cells
+        const auto cols = m_header.size();
+        const auto body = buffer.substr(static_cast<std::size_t>(tok.position() - buffer.data()));
+
+        std::vector<std::vector<std::string_view>> chunks(options.chunks(body.size()));
+        m_unescaped.resize(chunks.size());
+
+        parallel_tokenize<dialect_t>(body, chunks.size(), [&](std::size_t i, auto &chunk_tok, const char *stop) {
+            auto &cells = chunks[i];
+            cells.clear();
+            m_unescaped[i].clear();
+
+            while( chunk_tok.position() < stop )
+            {
+                const auto row = cells.size();
+                cells.resize(row + cols);
+
+                std::size_t n = 0;
+                chunk_tok.next_row([&](auto cell, bool escaped) {
+                    const auto slot = n < slots.size() ? slots[n] : load_options::skip;
+                    ++n;
+
+                    if( slot != load_options::skip )
+                        cells[row + slot] = store_cell<dialect_t>(cell, escaped, m_unescaped[i]);
+                });
+            }
+        });
+
+        // stitch the chunks together in order
+        if( chunks.size() == 1 )
+        {
+            m_cells = std::move(chunks.front());
+            m_cells.shrink_to_fit();
+        }
+        else
+        {
+            std::size_t size = 0;
+            for(const auto &chunk : chunks)
+                size += chunk.size();
+
+            m_cells.reserve(size);
+            for(const auto &chunk : chunks)
+                m_cells.insert(m_cells.end(), chunk.begin(), chunk.end());
+        }
+
+        m_table = table_view(m_cells.data(), cols == 0 ? 0 : m_cells.size() / cols, cols);
+
+        MCSV_STATS_ADD(&m_stats, rows_parsed, m_table.size());
+        MCSV_STATS_ADD(&m_stats, cells_parsed, m_cells.size());
+    }
+
+    mmap_loader(const mmap_loader &) = delete;
+    mmap_loader &operator=(const mmap_loader &) = delete;
+
+    /// @brief getter for the statistics of the loading and of the queries
+    stats_recorder &recorder() const
+    {
+        return m_stats;
+    }
+
+    /// @brief getter for the zone map, which is set by dataframe::build_index
+    zone_map_slot &zones() const
+    {
+        return m_zones;
+    }
+
+    /// @brief getter for the body of the csv-file
+    const auto &data() const
+    {
+        return m_table;
+    }
+
+    /// @brief getter for the header of the csv-file
+    const auto &header() const
+    {
+        return m_header;
+    }
+
+    /// @brief getter for a map, which relates indices and column-headers
+    const auto &header_map() const
+    {
+        return m_header_map;
+    }
+
+    /// @brief access a specific cell in the csv file
+    const auto &at(std::size_t row, std::size_t col) const
+    {
+        if( m_table.size() <= row )
+            throw std::runtime_error(
+                fmt::format("{}: csv file has only {} rows, but row {} has been requested",
+                            __func__, m_table.size(), row));
+
+        if( m_header.size() <= col )
+            throw std::runtime_error(
+                fmt::format("{}: csv file has only {} cols, but col {} has been requested",
+                            __func__, m_header.size(), col));
+
+        return m_cells[row * m_header.size() + col];
+    }
+};
+
+/// @brief fast and strict parsing of arithmetic types with std::from_chars. Booleans
+/// are parsed from true/false/1/0. The whole string must be consumed.
+/// @return false, if the string is no valid representation of a T
+template<class T>
+bool parse_arithmetic(std::string_view str, T &val)
+{
+    static_assert( std::is_arithmetic_v<T>, "parse_arithmetic is only possible for arithmetic types" );
+
+    if constexpr( std::is_same_v<T, bool> )
+    {
+        if( str == "true" || str == "1" )
+            val = true;
+        else if( str == "false" || str == "0" )
+            val = false;
+        else
+            return false;
+
+        return true;
+    }
+    else
+    {
+        // std::from_chars does not accept an explicit plus sign
+        if( str.size() > 1 && str.front() == '+' && str[1] != '-' )
+            str.remove_prefix(1);
+
+        const char *first = str.data();
+        const char *last = str.data() + str.size();
+
+#if defined(__cpp_lib_to_chars)
+        const auto [ptr, ec] = std::from_chars(first, last, val);
+        return ec == std::errc() && ptr == last;
+#else
+        if constexpr( std::is_integral_v<T> )
+        {
+            const auto [ptr, ec] = std::from_chars(first, last, val);
+            return ec == std::errc() && ptr == last;
+        }
+        else
+        {
+            // floating point std::from_chars is missing in older standard libraries
+            std::istringstream sstr{std::string(str)};
+            sstr.imbue(std::locale::classic());
+            sstr >> val;
+            return !sstr.fail() && sstr.peek() == std::char_traits<char>::eof();
+        }
+#endif
+    }
+}
+
+/// @brief name of an arithmetic type in error messages
+template<class T>
+constexpr const char *arithmetic_name()
+{
+    return std::is_same_v<T, bool> ? "boolean" : std::is_integral_v<T> ? "integer" : "floating point number";
+}
+
+/// @brief checks, if an arithmetic value converts to the arithmetic T without loss like in
+/// convert: integers accept only integral values in their range, booleans only 0 and 1, and
+/// floating point types finite values in their range
+template<class T, class S>
+bool arithmetic_fits(S val)
+{
+    if constexpr( std::is_same_v<T, S> )
+    {
+        return true;
+    }
+    else if constexpr( std::is_same_v<T, bool> )
+    {
+        return val == S(0) || val == S(1);
+    }
+    else if constexpr( std::is_integral_v<T> && std::is_floating_point_v<S> )
+    {
+        return std::trunc(val) == val &&
+               static_cast<double>(val) >= static_cast<double>(std::numeric_limits<T>::lowest()) &&
+               static_cast<double>(val) < std::ldexp(1.0, std::numeric_limits<T>::digits);
+    }
+    else if constexpr( std::is_integral_v<T> )
+    {
+        if constexpr( std::is_signed_v<S> && std::is_unsigned_v<T> )
+            return val >= 0 && static_cast<std::make_unsigned_t<S>>(val) <= std::numeric_limits<T>::max();
+        else if constexpr( std::is_unsigned_v<S> && std::is_signed_v<T> )
+            return val <= static_cast<std::make_unsigned_t<T>>(std::numeric_limits<T>::max());
+        else
+            return val >= std::numeric_limits<T>::lowest() && val <= std::numeric_limits<T>::max();
+    }
+    else if constexpr( std::is_floating_point_v<S> && sizeof(S) > sizeof(T) )
+    {
+        return !std::isfinite(val) || std::abs(val) <= static_cast<S>(std::numeric_limits<T>::max());
+    }
+    else
+    {
+        return true;
+    }
+}
+
+/// @brief generic convert function from string. special handling for empty strings.
+/// Arithmetic types are parsed with std::from_chars, integers also accept integral floating
+/// point values like 3.0. Other types are extracted with operator>>.
+/// @tparam T type to which the string is converted
+/// @param str string which will be converted
+/// @throw std::runtime_error, if the string is no valid representation of an arithmetic T
+template<class T>
+auto convert(std::string_view str)
+{
+    using value_t = std::remove_const_t<std::remove_reference_t<T>>;
+    value_t val{};
+
+    if constexpr( std::is_constructible_v<value_t, std::string_view> )
+    {
+        // string-like types take the whole cell, not only the first word
+        val = value_t(str);
+    }
+    else if constexpr( std::is_arithmetic_v<value_t> )
+    {
+        // empty cells convert to 0 for arithmetic types
+        if( str.empty() || parse_arithmetic(str, val) )
+            return val;
+
+        if constexpr( std::is_integral_v<value_t> && !std::is_same_v<value_t, bool> )
+        {
+            double d;
+            if( parse_arithmetic(str, d) && std::trunc(d) == d &&
+                d >= static_cast<double>(std::numeric_limits<value_t>::lowest()) &&
+                d < std::ldexp(1.0, std::numeric_limits<value_t>::digits) )
+                return static_cast<value_t>(d);
+        }
+
+        throw std::runtime_error(
+            fmt::format("{}: cell '{}' is no valid {}", __func__, str, arithmetic_name<value_t>()));
+    }
+    else
+    {
+        std::stringstream sstr{std::string(str)};
+        sstr >> val;
+    }
+    return val;
+}
+
+/// @brief convert helper function for rows (std::vector or row_view)
+template<class T, class row_t, typename = std::enable_if_t<!std::is_convertible_v<row_t, std::string_view>>>
+auto convert(const row_t &str_vec)
+{
+    std::vector<T> val_vec;
+    val_vec.reserve(str_vec.size());
+
+    for(auto &str : str_vec)
+        val_vec.push_back( convert<T>(str) );
+
+    return val_vec;
+}
+
+/// @brief strict convert function, which fails if the string is not completely consumed
+/// @return false, if the string is no valid representation of a T
+template<class T>
+bool try_convert(std::string_view str, T &val)
+{
+    if constexpr( std::is_arithmetic_v<T> )
+    {
+        return parse_arithmetic(str, val);
+    }
+    else
+    {
+        std::istringstream sstr{std::string(str)};
+        sstr >> val;
+        return !sstr.fail() && sstr.peek() == std::char_traits<char>::eof();
+    }
+}
+
+/// @brief contiguous buffer of a typed column, which either owns its values or is a view on
+/// values owned by someone else, e.g. on the memory-mapped snapshot of a columnar_loader
+template<class T>
+class column_buffer
+{
+    std::vector<T> m_values;
+    const T *m_data = nullptr;
+    std::size_t m_size = 0;
+
+public:
+    using value_type = T;
+
+    column_buffer() = default;
+
+    /// @brief takes the ownership of the values
+    column_buffer(std::vector<T> values) :
+        m_values(std::move(values)), m_data(m_values.data()), m_size(m_values.size()) {}
+
+    /// @brief views size values at data, which must outlive the buffer
+    column_buffer(const T *data, std::size_t size) :
+        m_data(data), m_size(size) {}
+
+    column_buffer(const column_buffer &other) :
+        m_values(other.m_values), m_data(other.m_values.empty() ? other.m_data : m_values.data()), m_size(other.m_size) {}
+
+    column_buffer(column_buffer &&) = default;
+    column_buffer &operator=(column_buffer &&) = default;
+
+    column_buffer &operator=(const column_buffer &other)
+    {
+        return *this = column_buffer(other);
+    }
+
+    const T *data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    const T *begin() const { return m_data; }
+    const T *end() const { return m_data + m_size; }
+
+    const T &operator[](std::size_t i) const { return m_data[i]; }
+};
+
+/// @brief dictionary-encoded string column. Each distinct string is stored once in the pool,
+/// each row stores only the index (code) of its string in the pool.
+struct dictionary_column
+{
+    using value_type = std::string;
+
+    std::vector<std::string> pool;
+    column_buffer<std::uint32_t> codes;
+
+    const std::string &operator[](std::size_t row) const
+    {
+        return pool[codes[row]];
+    }
+
+    /// @brief the codes are the contiguous buffer of the column
+    const std::uint32_t *data() const
+    {
+        return codes.data();
+    }
+
+    std::size_t size() const
+    {
+        return codes.size();
+    }
+};
+
+/// @brief converts a value stored by a typed loader to T. Arithmetic types are casted, if
+/// the value fits (see arithmetic_fits), the others are converted from the stored string or
+/// its formatted value. Booleans (stored as std::uint8_t) are formatted as true/false.
+/// @throw std::runtime_error, if an arithmetic value does not fit into an arithmetic T
+template<class T, class stored_t>
+T cast_stored(const stored_t &val)
+{
+    if constexpr( std::is_same_v<stored_t, T> )
+    {
+        return val;
+    }
+    else if constexpr( std::is_same_v<stored_t, std::string> )
+    {
+        return convert<T>(val);
+    }
+    else if constexpr( std::is_arithmetic_v<T> )
+    {
+        if( !arithmetic_fits<T>(val) )
+            throw std::runtime_error(fmt::format("{}: cell '{}' is no valid {}", __func__, val, arithmetic_name<T>()));
+
+        return static_cast<T>(val);
+    }
+    else if constexpr( std::is_same_v<stored_t, std::uint8_t> )
+    {
+        return convert<T>(val ? "true" : "false");
+    }
+    else
+    {
+        return convert<T>(fmt::format("{}", val));
+    }
+}
+
+/// @brief proxy for a single row of a typed loader, whose cells are formatted as std::string
+/// on access with loader_t::get<std::string>(row, col)
+template<class loader_t>
+class formatted_row
+{
+    const loader_t *m_loader;
+    std::size_t m_row;
+
+public:
+    class const_iterator
+    {
+        const loader_t *m_loader;
+        std::size_t m_row;
+        std::size_t m_col;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::string;
+
+        const_iterator(const loader_t *loader, std::size_t row, std::size_t col) :
+            m_loader(loader), m_row(row), m_col(col) {}
+
+        std::string operator*() const { return m_loader->template get<std::string>(m_row, m_col); }
+        auto &operator++() { ++m_col; return *this; }
+        bool operator==(const const_iterator &other) const { return m_col == other.m_col; }
+        bool operator!=(const const_iterator &other) const { return m_col != other.m_col; }
+    };
+
+    using value_type = std::string;
+
+    formatted_row(const loader_t *loader, std::size_t row) :
+        m_loader(loader), m_row(row) {}
+
+    const_iterator begin() const { return const_iterator(m_loader, m_row, 0); }
+    const_iterator end() const { return const_iterator(m_loader, m_row, size()); }
+    std::size_t size() const { return m_loader->header().size(); }
+
+    std::string operator[](std::size_t col) const { return m_loader->template get<std::string>(m_row, col); }
+};
+
+/// @brief proxy for the whole table of a typed loader, behaves like a container of formatted_row objects
+template<class loader_t>
+class formatted_table
+{
+    const loader_t *m_loader;
+
+public:
+    class const_iterator
+    {
+        const loader_t *m_loader;
+        std::size_t m_row;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = formatted_row<loader_t>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = formatted_row<loader_t>;
+
+        const_iterator(const loader_t *loader, std::size_t row) :
+            m_loader(loader), m_row(row) {}
+
+        auto operator*() const { return formatted_row<loader_t>(m_loader, m_row); }
+        auto &operator++() { ++m_row; return *this; }
+        bool operator==(const const_iterator &other) const { return m_row == other.m_row; }
+        bool operator!=(const const_iterator &other) const { return m_row != other.m_row; }
+    };
+
+    using value_type = formatted_row<loader_t>;
+    using iterator = const_iterator;
+
+    formatted_table(const loader_t *loader) :
+        m_loader(loader) {}
+
+    const_iterator begin() const { return const_iterator(m_loader, 0); }
+    const_iterator end() const { return const_iterator(m_loader, size()); }
+    std::size_t size() const { return m_loader->rows(); }
+
+    auto operator[](std::size_t row) const { return formatted_row<loader_t>(m_loader, row); }
+};
+
+/// @brief Data storage class, which stores each column as a contiguous buffer of a fixed type
+/// (see column_type). The types are given by the mcsv::column_types option or are inferred:
+/// the first of boolean (true/false), int64, float64 and string which fits all non-empty cells.
+/// The cells are therefore converted only once, which makes repeated filtering and exporting
+/// cheap. data() still provides all cells as strings, they are formatted on access.
+class columnar_loader
+{
+public:
+    using column_data = std::variant<column_buffer<std::int64_t>, column_buffer<double>,
+                                     column_buffer<std::uint8_t>, std::vector<std::string>,
+                                     dictionary_column>;
+
+    using row_proxy = formatted_row<columnar_loader>;
+    using table_proxy = formatted_table<columnar_loader>;
+
+private:
+    // the mapped snapshot, if the columns are read from one. Numeric and code columns view it.
+    std::optional<mapped_file> m_snapshot;
+    std::filesystem::path m_snapshot_path;
+
+    std::vector<column_data> m_columns;
+    std::vector<std::string> m_header;
+    std::map<std::string, std::size_t> m_header_map;
+    std::size_t m_rows = 0;
+
+    // bytes and checksums of the columns viewed from the snapshot, which are verified on first access
+    std::vector<std::pair<std::string_view, std::uint64_t>> m_checks;
+    mutable std::unique_ptr<std::atomic<bool>[]> m_verified;
+    mutable std::mutex m_verify_mutex;
+
+    table_proxy m_table{this};
+
+    mutable stats_recorder m_stats;
+    mutable zone_map_slot m_zones;
+
+    /// @brief finds the narrowest type, which can represent all non-empty cells of a column
+    template<class raw_loader_t>
+    static auto infer_type(const raw_loader_t &raw, std::size_t col)
+    {
+        bool boolean = true, int64 = true, float64 = true, any = false;
+
+        for(const auto &row : raw.data())
+        {
+            const std::string_view cell = row[col];
+
+            if( cell.empty() )
+                continue;
+
+            any = true;
+            boolean = boolean && (cell == "true" || cell == "false");
+
+            std::int64_t i;
+            int64 = int64 && try_convert(cell, i);
+
+            double d;
+            float64 = float64 && try_convert(cell, d);
+
+            if( !boolean && !int64 && !float64 )
+                break;
+        }
+
+        if( !any )
+            return column_type::string;
+        if( boolean )
+            return column_type::boolean;
+        if( int64 )
+            return column_type::int64;
+        if( float64 )
+            return column_type::float64;
+
+        return column_type::string;
+    }
+
+    /// @brief converts a column of the raw loader into a typed buffer
+    template<class T, class raw_loader_t>
+    static auto make_column(const raw_loader_t &raw, std::size_t col)
+    {
+        std::vector<T> column;
+        column.reserve(raw.data().size());
+
+        std::size_t r = 0;
+        for(const auto &row : raw.data())
+        {
+            const std::string_view cell = row[col];
+            auto &val = column.emplace_back();
+
+            if constexpr( std::is_same_v<T, std::string> )
+            {
+                val = cell;
+            }
+            else
+            {
+                bool value = true;
+                if( !cell.empty() && !(std::is_same_v<T, std::uint8_t> ? try_convert(cell, value) : try_convert(cell, val)) )
+                    throw std::runtime_error(
+                        fmt::format("{}: cell '{}' in row {} of column '{}' cannot be converted to the column type",
+                                    __func__, cell, r, raw.header()[col]));
+
+                if constexpr( std::is_same_v<T, std::uint8_t> )
+                    val = value;
+            }
+            ++r;
+        }
+
+        return column;
+    }
+
+    /// @brief dictionary-encodes a column of the raw loader
+    /// @param max_pool_size the encoding is stopped, if the column has more distinct values
+    /// @return the column, or std::nullopt if the encoding was stopped
+    template<class raw_loader_t>
+    static std::optional<dictionary_column> make_dictionary(const raw_loader_t &raw, std::size_t col,
+                                                            std::size_t max_pool_size)
+    {
+        dictionary_column column;
+        std::vector<std::uint32_t> row_codes;
+        row_codes.reserve(raw.data().size());
+
+        // the cells of the raw loader stay valid during loading, so they can be used as keys
+        std::unordered_map<std::string_view, std::uint32_t> codes;
+
+        for(const auto &row : raw.data())
+        {
+            const std::string_view cell = row[col];
+            const auto [it, inserted] = codes.emplace(cell, static_cast<std::uint32_t>(column.pool.size()));
+
+            if( inserted )
+            {
+                if( column.pool.size() == max_pool_size )
+                    return std::nullopt;
+
+                column.pool.emplace_back(cell);
+            }
+
+            row_codes.push_back(it->second);
+        }
+
+        column.pool.shrink_to_fit();
+        column.codes = std::move(row_codes);
+        return column;
+    }
+
+    /// @brief magic bytes at the start of a snapshot file, including the format version
+    static constexpr std::string_view snapshot_magic = "MCSVSNP2";
+
+    /// @brief identifies the csv-file and the options, from which a snapshot is made: file size,
+    /// modification time, hash of the first and last 64 KiB of the file and hash of the options
+    /// and of the dialect
+    static std::array<std::uint64_t, 4> snapshot_key(const std::filesystem::path &path, const load_options &options,
+                                                     const std::string &dialect_key)
+    {
+        constexpr std::size_t sample_size = 1ul << 16;
+
+        const std::uint64_t size = std::filesystem::file_size(path);
+        const auto mtime = static_cast<std::uint64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+
+        std::string sample(2 * sample_size, '\0');
+        const auto part = static_cast<std::streamsize>(std::min<std::uint64_t>(size, sample_size));
+
+        std::ifstream file(path, std::ios::binary);
+        file.read(sample.data(), part);
+        file.seekg(-part, std::ios::end);
+        file.read(sample.data() + sample_size, part);
+
+        std::string option_bytes = dialect_key;
+        for(const auto &[name, type] : options.column_types)
+            option_bytes += fmt::format("{}:{}={};", name.size(), name, static_cast<int>(type));
+        for(const auto &name : options.columns)
+            option_bytes += fmt::format("{}:{};", name.size(), name);
+
+        return { size, mtime, hash_bytes(sample), hash_bytes(option_bytes) };
+    }
+
+    /// @brief appends the bytes of n trivially copyable values to a buffer
+    template<class T>
+    static void append_bytes(std::string &buffer, const T *values, std::size_t n)
+    {
+        buffer.append(reinterpret_cast<const char *>(values), n * sizeof(T));
+    }
+
+    /// @brief appends strings as n+1 offsets followed by the concatenated characters
+    static void append_strings(std::string &buffer, const std::vector<std::string> &strings)
+    {
+        std::vector<std::uint64_t> offsets(strings.size() + 1, 0);
+        for(std::size_t i=0ul; i<strings.size(); ++i)
+            offsets[i + 1] = offsets[i] + strings[i].size();
+
+        append_bytes(buffer, offsets.data(), offsets.size());
+        for(const auto &str : strings)
+            buffer += str;
+    }
+
+    /// @brief appends zeros up to the next multiple of 8 bytes, offset is the position of the
+    /// end of the buffer in the file
+    static void append_padding(std::string &buffer, std::uint64_t offset)
+    {
+        buffer.append((8 - offset % 8) % 8, '\0');
+    }
+
+    /// @brief bounds-checked reading position in a snapshot file. After the first failed
+    /// read, ok is false and all further reads fail.
+    struct snapshot_cursor
+    {
+        std::string_view rest;
+        const char *begin = nullptr;
+        bool ok = true;
+
+        /// @brief skips the padding up to the next multiple of 8 bytes from begin
+        void align()
+        {
+            take((8 - static_cast<std::uint64_t>(rest.data() - begin) % 8) % 8);
+        }
+
+        std::string_view take(std::uint64_t n)
+        {
+            if( !ok || n > rest.size() )
+            {
+                ok = false;
+                return {};
+            }
+
+            const auto bytes = rest.substr(0, n);
+            rest.remove_prefix(n);
+            return bytes;
+        }
+
+        template<class T>
+        T read()
+        {
+            T value{};
+            const auto bytes = take(sizeof(T));
+
+            if( ok )
+                std::memcpy(&value, bytes.data(), sizeof(T));
+
+            return value;
+        }
+
+        template<class T>
+        void read_array(std::vector<T> &values, std::uint64_t n)
+        {
+            if( n > rest.size() / sizeof(T) )
+                ok = false;
+
+            const auto bytes = take(n * sizeof(T));
+
+            if( ok )
+            {
+                values.resize(n);
+                std::memcpy(values.data(), bytes.data(), bytes.size());
+            }
+        }
+
+        void read_strings(std::vector<std::string> &strings, std::uint64_t n)
+        {
+            if( n >= rest.size() )
+                ok = false;
+
+            std::vector<std::uint64_t> offsets;
+            read_array(offsets, n + 1);
+            const auto chars = take(ok ? offsets.back() : 0);
+
+            if( !ok )
+                return;
+
+            strings.resize(n);
+            for(std::size_t i=0ul; i<n && ok; ++i)
+            {
+                ok = offsets[i] <= offsets[i + 1] && offsets[i + 1] <= chars.size();
+
+                if( ok )
+                    strings[i].assign(chars.substr(offsets[i], offsets[i + 1] - offsets[i]));
+            }
+        }
+    };
+
+    /// @brief writes the typed columns to a snapshot file. The file is written to a temporary
+    /// file first and then renamed, so readers never see a partially written snapshot. Each
+    /// column is stored as name, type, sizes and checksums of its strings (string cells or the
+    /// dictionary pool) and of its values (numbers or codes), followed by the strings and the
+    /// values. The values start at multiples of 8 bytes, so they can be viewed in the mapping.
+    /// If the file cannot be written, no snapshot is made.
+    void write_snapshot(const std::filesystem::path &snapshot_path, const std::array<std::uint64_t, 4> &key) const
+    {
+        const auto tmp_path = std::filesystem::path(snapshot_path.string() + ".tmp");
+        std::ofstream file(tmp_path, std::ios::binary);
+
+        if( !file )
+            return;
+
+        std::string buffer(snapshot_magic);
+        append_bytes(buffer, key.data(), key.size());
+
+        const std::array<std::uint64_t, 2> sizes = { m_rows, m_header.size() };
+        append_bytes(buffer, sizes.data(), sizes.size());
+
+        std::uint64_t offset = 0;
+        std::string strings, values;
+        for(std::size_t col=0ul; col<m_columns.size(); ++col)
+        {
+            strings.clear();
+            values.clear();
+            std::visit([&](const auto &column) {
+                using column_t = std::decay_t<decltype(column)>;
+
+                if constexpr( std::is_same_v<column_t, std::vector<std::string>> )
+                {
+                    append_strings(strings, column);
+                }
+                else if constexpr( std::is_same_v<column_t, dictionary_column> )
+                {
+                    const std::uint64_t pool_size = column.pool.size();
+                    append_bytes(strings, &pool_size, 1);
+                    append_strings(strings, column.pool);
+                    append_bytes(values, column.codes.data(), column.codes.size());
+                }
+                else
+                {
+                    append_bytes(values, column.data(), column.size());
+                }
+            }, m_columns[col]);
+
+            const std::uint64_t name_size = m_header[col].size();
+            append_bytes(buffer, &name_size, 1);
+            buffer += m_header[col];
+            append_padding(buffer, offset + buffer.size());
+
+            const std::array<std::uint64_t, 5> meta = { m_columns[col].index(), strings.size(), hash_bytes(strings),
+                                                        values.size(), hash_bytes(values) };
+            append_bytes(buffer, meta.data(), meta.size());
+            buffer += strings;
+            append_padding(buffer, offset + buffer.size());
+
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            file.write(values.data(), static_cast<std::streamsize>(values.size()));
+            offset += buffer.size() + values.size();
+
+            buffer.clear();
+            append_padding(buffer, offset);
+        }
+
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+        file.close();
+
+        std::error_code ec;
+        if( file )
+            std::filesystem::rename(tmp_path, snapshot_path, ec);
+        if( !file || ec )
+            std::filesystem::remove(tmp_path, ec);
+    }
+
+    /// @brief views n values of type T in the bytes of a snapshot. Values at an address, which
+    /// is not aligned for T, are copied instead.
+    /// @return false, if the bytes do not hold exactly n values
+    template<class T>
+    static bool view_array(std::string_view bytes, std::uint64_t n, column_buffer<T> &column)
+    {
+        if( bytes.size() % sizeof(T) != 0 || bytes.size() / sizeof(T) != n )
+            return false;
+
+        if( reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(T) == 0 )
+        {
+            column = column_buffer<T>(reinterpret_cast<const T *>(bytes.data()), n);
+        }
+        else
+        {
+            std::vector<T> values(n);
+            std::memcpy(values.data(), bytes.data(), bytes.size());
+            column = column_buffer<T>(std::move(values));
+        }
+
+        return true;
+    }
+
+    /// @brief reads the typed columns from a snapshot file, which is memory-mapped and kept open.
+    /// Numeric and code columns are views on the mapping, only strings are copied. The checksums
+    /// of the strings are verified here, those of the viewed values on first access (see verify).
+    /// @return false, if the file does not exist, is stale or corrupt
+    bool read_snapshot(const std::filesystem::path &snapshot_path, const std::array<std::uint64_t, 4> &key)
+    {
+        std::error_code ec;
+        if( !std::filesystem::is_regular_file(snapshot_path, ec) )
+            return false;
+
+        m_snapshot.emplace(snapshot_path);
+        const auto bytes = m_snapshot->view();
+        snapshot_cursor in{bytes, bytes.data()};
+
+        if( in.take(snapshot_magic.size()) != snapshot_magic )
+            return false;
+
+        for(auto k : key)
+            if( in.read<std::uint64_t>() != k )
+                return false;
+
+        const auto rows = in.read<std::uint64_t>();
+        const auto cols = in.read<std::uint64_t>();
+
+        std::vector<std::string> header;
+        std::vector<column_data> columns;
+        std::vector<std::pair<std::string_view, std::uint64_t>> checks;
+
+        for(std::uint64_t col=0ul; col<cols && in.ok; ++col)
+        {
+            header.emplace_back(in.take(in.read<std::uint64_t>()));
+            in.align();
+
+            const auto type = in.read<std::uint64_t>();
+            const auto strings_size = in.read<std::uint64_t>();
+            const auto strings_checksum = in.read<std::uint64_t>();
+            const auto values_size = in.read<std::uint64_t>();
+            const auto values_checksum = in.read<std::uint64_t>();
+
+            snapshot_cursor strings{in.take(strings_size)};
+            in.align();
+            const auto values = in.take(values_size);
+            in.align();
+
+            if( !in.ok || hash_bytes(strings.rest) != strings_checksum )
+                return false;
+
+            bool ok = true;
+            switch( static_cast<column_type>(type) )
+            {
+            case column_type::int64:
+                ok = view_array(values, rows, std::get<0>(columns.emplace_back(std::in_place_index<0>)));
+                break;
+            case column_type::float64:
+                ok = view_array(values, rows, std::get<1>(columns.emplace_back(std::in_place_index<1>)));
+                break;
+            case column_type::boolean:
+                ok = view_array(values, rows, std::get<2>(columns.emplace_back(std::in_place_index<2>)));
+                break;
+            case column_type::string:
+                strings.read_strings(std::get<3>(columns.emplace_back(std::in_place_index<3>)), rows);
+                ok = values.empty();
+                break;
+            case column_type::category:
+            {
+                auto &dict = std::get<4>(columns.emplace_back(std::in_place_index<4>));
+                strings.read_strings(dict.pool, strings.read<std::uint64_t>());
+                ok = view_array(values, rows, dict.codes);
+                break;
+            }
+            default:
+                return false;
+            }
+
+            if( !ok || !strings.ok || !strings.rest.empty() )
+                return false;
+
+            checks.emplace_back(values, values_checksum);
+        }
+
+        if( !in.ok || !in.rest.empty() )
+            return false;
+
+        m_rows = rows;
+        m_header = std::move(header);
+        m_columns = std::move(columns);
+        m_checks = std::move(checks);
+        m_snapshot_path = snapshot_path;
+
+        m_verified = std::make_unique<std::atomic<bool>[]>(m_columns.size());
+        for(std::size_t col=0ul; col<m_columns.size(); ++col)
+            m_verified[col].store(m_checks[col].first.empty());
+
+        for(std::size_t col=0ul; col<m_header.size(); ++col)
+            m_header_map[m_header[col]] = col;
+
+        return true;
+    }
+
+    /// @brief verifies the checksum of a column viewed from the snapshot on its first access
+    /// @throw std::runtime_error, if the column is corrupt. The snapshot is removed then, so the
+    /// next load parses the csv-file again and replaces it.
+    void verify(std::size_t col) const
+    {
+        if( !m_verified || m_verified[col].load(std::memory_order_acquire) )
+            return;
+
+        std::lock_guard<std::mutex> lock(m_verify_mutex);
+
+        if( m_verified[col].load(std::memory_order_relaxed) )
+            return;
+
+        const auto &[bytes, checksum] = m_checks[col];
+        bool ok = hash_bytes(bytes) == checksum;
+
+        if( const auto *dict = std::get_if<dictionary_column>(&m_columns[col]) )
+            ok = ok && std::all_of(dict->codes.begin(), dict->codes.end(), [&](auto code) { return code < dict->pool.size(); });
+
+        if( !ok )
+        {
+            std::error_code ec;
+            std::filesystem::remove(m_snapshot_path, ec);
+            throw std::runtime_error(fmt::format("{}: column '{}' of the snapshot '{}' is corrupt",
+                                                 __func__, m_header[col], m_snapshot_path.string()));
+        }
+
+        m_verified[col].store(true, std::memory_order_release);
+    }
+
+    /// @brief parses the file and converts each column to its type
+    template<class dialect_t>
+    void load(const std::filesystem::path &path, const load_options &options)
+    {
+        const mmap_loader raw(path, options, dialect_t{});
+
+        m_stats.merge(raw.recorder());
+        MCSV_STATS_PHASE(&m_stats, convert);
+
+        m_header = raw.header();
+        m_header_map = raw.header_map();
+        m_rows = raw.data().size();
+
+        for(std::size_t col=0ul; col<m_header.size(); ++col)
+        {
+            const auto fixed = options.column_types.find(m_header[col]);
+            const auto type = fixed != options.column_types.end() ? fixed->second : infer_type(raw, col);
+
+            switch( type )
+            {
+            case column_type::int64: m_columns.emplace_back(make_column<std::int64_t>(raw, col)); break;
+            case column_type::float64: m_columns.emplace_back(make_column<double>(raw, col)); break;
+            case column_type::boolean: m_columns.emplace_back(make_column<std::uint8_t>(raw, col)); break;
+            case column_type::string:
+                if( auto dict = fixed == options.column_types.end() ? make_dictionary(raw, col, m_rows / 2) : std::nullopt )
+                    m_columns.emplace_back(std::move(*dict));
+                else
+                    m_columns.emplace_back(make_column<std::string>(raw, col));
+                break;
+            case column_type::category:
+                m_columns.emplace_back(*make_dictionary(raw, col, std::numeric_limits<std::uint32_t>::max()));
+                break;
+            }
+        }
+    }
+
+public:
+    /// @brief loads the file and converts each column to its type. Inferred string columns
+    /// with at most half as many distinct values as rows are dictionary-encoded. With
+    /// the snapshot option, a valid snapshot is read instead, otherwise it is written.
+    columnar_loader(std::filesystem::path path, const load_options &options = {}) :
+        columnar_loader(path, options, dialect<>{})
+    {
+    }
+
+    /// @brief loads a file of the given dialect, see above
+    template<class dialect_t>
+    columnar_loader(std::filesystem::path path, const load_options &options, dialect_t)
+    {
+        if( !options.snapshot )
+        {
+            load<dialect_t>(path, options);
+            return;
+        }
+
+        const auto snapshot_path = options.snapshot_path.empty() ? std::filesystem::path(path.string() + ".mcsv")
+                                                                 : options.snapshot_path;
+        const auto key = snapshot_key(path, options, dialect_t::key());
+
+        if( read_snapshot(snapshot_path, key) )
+            return;
+
+        m_snapshot.reset();
+        load<dialect_t>(path, options);
+        write_snapshot(snapshot_path, key);
+    }
+
+    columnar_loader(const columnar_loader &) = delete;
+    columnar_loader &operator=(const columnar_loader &) = delete;
+
+    /// @brief getter for the statistics of the loading and of the queries
+    stats_recorder &recorder() const
+    {
+        return m_stats;
+    }
+
+    /// @brief getter for the zone map, which is set by dataframe::build_index
+    zone_map_slot &zones() const
+    {
+        return m_zones;
+    }
+
+    /// @brief getter for the body of the csv-file, the cells are formatted as strings on access
+    const auto &data() const
+    {
+        return m_table;
+    }
+
+    /// @brief getter for the header of the csv-file
+    const auto &header() const
+    {
+        return m_header;
+    }
+
+    /// @brief getter for a map, which relates indices and column-headers
+    const auto &header_map() const
+    {
+        return m_header_map;
+    }
+
+    /// @brief number of rows
+    std::size_t rows() const
+    {
+        return m_rows;
+    }
+
+    /// @brief getter for the type of a column
+    auto type(std::size_t col) const
+    {
+        return static_cast<column_type>(m_columns.at(col).index());
+    }
+
+    /// @brief getter for the typed storage of a column
+    const auto &column(std::size_t col) const
+    {
+        const auto &storage = m_columns.at(col);
+        verify(col);
+        return storage;
+    }
+
+    /// @brief returns the dictionary of a category column, or nullptr for other columns
+    const dictionary_column *dictionary(std::size_t col) const
+    {
+        return std::get_if<dictionary_column>(&column(col));
+    }
+
+    /// @brief calls fn(const S *data, std::size_t size) with the contiguous typed buffer of a
+    /// column, S is the stored type (std::int64_t, double, std::uint8_t or std::string, or the
+    /// std::uint32_t codes for category columns)
+    template<class fn_t>
+    decltype(auto) visit_column(std::size_t col, fn_t &&fn) const
+    {
+        return std::visit([&](const auto &column) {
+            return fn(column.data(), column.size());
+        }, column(col));
+    }
+
+    /// @brief typed access to a cell. Arithmetic types are casted from the stored value, if it
+    /// fits (see cast_stored), the others are converted from the stored string or its formatted
+    /// value. Booleans are formatted as true/false.
+    template<class T>
+    T get(std::size_t row, std::size_t col) const
+    {
+        verify(col);
+
+        return std::visit([row](const auto &column) -> T {
+            using stored_t = typename std::decay_t<decltype(column)>::value_type;
+            return cast_stored<T, stored_t>(column[row]);
+        }, m_columns[col]);
+    }
+
+    /// @brief access a specific cell in the csv file, formatted as std::string
+    auto at(std::size_t row, std::size_t col) const
+    {
+        if( m_rows <= row )
+            throw std::runtime_error(
+                fmt::format("{}: csv file has only {} rows, but row {} has been requested",
+                            __func__, m_rows, row));
+
+        if( m_header.size() <= col )
+            throw std::runtime_error(
+                fmt::format("{}: csv file has only {} cols, but col {} has been requested",
+                            __func__, m_header.size(), col));
+
+        return get<std::string>(row, col);
+    }
+};
+
+/// @brief compile-time description of the column types of a csv-file, used with
+/// read_csv<mcsv::schema<int, double, std::string>>(path)
+/// @tparam Ts the types of the columns, in the order of the csv-file (or of the mcsv::columns option)
+template<class... Ts>
+struct schema {};
+
+template<class T>
+struct is_schema : std::false_type {};
+
+template<class... Ts>
+struct is_schema<schema<Ts...>> : std::true_type {};
+
+template<class T>
+inline constexpr bool is_schema_v = is_schema<T>::value;
+
+/// @brief type, in which a column of type T is stored by the schema_loader (std::uint8_t for
+/// bool, so the buffer is contiguous)
+template<class T>
+using schema_storage_t = std::conditional_t<std::is_same_v<T, bool>, std::uint8_t, T>;
+
+/// @brief Data storage class for files with a schema known at compile time. The cells are
+/// converted to the column types already while tokenizing, without an intermediate string
+/// or cell index, and each column is stored in a std::vector of its type. Empty cells become
+/// a value-initialized T. data() provides all cells as strings, they are formatted on access.
+/// @tparam Ts the types of the columns
+template<class... Ts>
+class schema_loader
+{
+    static_assert( sizeof...(Ts) > 0, "a schema needs at least one column" );
+
+public:
+    using columns_t = std::tuple<std::vector<schema_storage_t<Ts>>...>;
+    using row_proxy = formatted_row<schema_loader>;
+    using table_proxy = formatted_table<schema_loader>;
+
+private:
+    columns_t m_columns;
+    std::vector<std::string> m_header;
+    std::map<std::string, std::size_t> m_header_map;
+    std::size_t m_rows = 0;
+
+    table_proxy m_table{this};
+
+    mutable stats_recorder m_stats;
+    mutable zone_map_slot m_zones;
+
+    /// @brief first cell of a chunk, which could not be converted
+    struct cell_error
+    {
+        std::size_t row, col;
+        std::string cell;
+    };
+
+    /// @brief converts an unescaped cell and stores it as the last value of column I
+    /// @return false, if the cell cannot be converted
+    template<std::size_t I>
+    static bool store_cell(columns_t &columns, std::string_view cell)
+    {
+        using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+        return store_value<T>(std::get<I>(columns).back(), cell);
+    }
+
+    template<class T>
+    static bool store_value(schema_storage_t<T> &val, std::string_view cell)
+    {
+        if constexpr( std::is_same_v<T, std::string> )
+        {
+            val = cell;
+            return true;
+        }
+        else if constexpr( std::is_same_v<T, bool> )
+        {
+            bool value = false;
+            const bool ok = cell.empty() || try_convert(cell, value);
+            val = value;
+            return ok;
+        }
+        else
+        {
+            return cell.empty() || try_convert(cell, val);
+        }
+    }
+
+    using store_fn = bool (*)(columns_t &, std::string_view);
+
+    template<std::size_t... I>
+    static constexpr std::array<store_fn, sizeof...(Ts)> make_store_table(std::index_sequence<I...>)
+    {
+        return { &store_cell<I>... };
+    }
+
+    /// @brief the conversion function of each column, indexed by the column
+    static constexpr auto store_table = make_store_table(std::index_sequence_for<Ts...> {});
+
+    /// @brief calls fn(column) with the typed buffer of column I
+    template<std::size_t I, class fn_t>
+    static decltype(auto) call_with_column(const columns_t &columns, fn_t &fn)
+    {
+        return fn(std::get<I>(columns));
+    }
+
+    /// @brief calls fn(column) with the typed buffer of a column given at run time. fn must
+    /// return the same type for all columns.
+    template<class fn_t, std::size_t... I>
+    static decltype(auto) dispatch(const columns_t &columns, std::size_t col, fn_t &fn, std::index_sequence<I...>)
+    {
+        using result_t = decltype(fn(std::get<0>(columns)));
+        constexpr std::array<result_t (*)(const columns_t &, fn_t &), sizeof...(I)> table = { &call_with_column<I, fn_t>... };
+
+        return table[col](columns, fn);
+    }
+
+    template<class fn_t>
+    decltype(auto) dispatch(std::size_t col, fn_t &&fn) const
+    {
+        if( col >= sizeof...(Ts) )
+            throw std::runtime_error(
+                fmt::format("{}: schema has only {} cols, but col {} has been requested", __func__, sizeof...(Ts), col));
+
+        return dispatch(m_columns, col, fn, std::index_sequence_for<Ts...> {});
+    }
+
+public:
+    /// @brief maps the file and converts the cells directly into the typed columns
+    schema_loader(std::filesystem::path path, const load_options &options = {}) :
+        schema_loader(path, options, dialect<>{})
+    {
+    }
+
+    /// @brief maps a file of the given dialect and converts the cells directly into the typed columns
+    template<class dialect_t>
+    schema_loader(std::filesystem::path path, const load_options &options, dialect_t)
+    {
+        using tokenizer_t = basic_tokenizer<dialect_t>;
+
+        const mapped_file file(path, options.threads);
+        const auto buffer = file.view();
+        MCSV_STATS_ADD(&m_stats, bytes_read, buffer.size());
+        MCSV_STATS_PHASE(&m_stats, tokenize);
+
+        tokenizer_t tok(buffer);
+
+        m_header = tok.read_header();
+
+        const auto slots = options.project(m_header);
+
+        if( m_header.size() != sizeof...(Ts) )
+            throw std::runtime_error(
+                fmt::format("{}: schema has {} columns, but '{}' has {} (loaded) columns",
+                            __func__, sizeof...(Ts), path.string(), m_header.size()));
+
+        for(std::size_t i=0ul; i<m_header.size(); ++i)
+            if( !m_header_map.emplace(m_header[i], i).second )
+                throw std::runtime_error("csv-file contains multiple columns with the same name!");
+
+        // body, each row gets exactly one value per column
+        const auto body = buffer.substr(static_cast<std::size_t>(tok.position() - buffer.data()));
+
+        std::vector<columns_t> chunks(options.chunks(body.size()));
+        std::vector<std::optional<cell_error>> errors(chunks.size());
+
+        parallel_tokenize<dialect_t>(body, chunks.size(), [&](std::size_t i, auto &chunk_tok, const char *stop) {
+            auto &columns = chunks[i];
+            auto &error = errors[i];
+
+            // discard the results of a previous call, see parallel_tokenize
+            columns = columns_t{};
+            error.reset();
+
+            // a mis-synchronized chunk can contain garbage, so errors are only reported
+            // after parallel_tokenize has validated the chunk boundaries
+            std::size_t row = 0;
+            while( chunk_tok.position() < stop )
+            {
+                std::apply([](auto &... column) { (column.emplace_back(), ...); }, columns);
+
+                std::size_t n = 0;
+                chunk_tok.next_row([&](auto cell, bool escaped) {
+                    const auto slot = n < slots.size() ? slots[n] : load_options::skip;
+                    ++n;
+
+                    if( slot == load_options::skip )
+                        return;
+
+                    const bool stored = escaped ? store_table[slot](columns, tokenizer_t::unescape(cell))
+                                                : store_table[slot](columns, cell);
+
+                    if( !stored && !error )
+                        error = cell_error{row, slot, std::string(cell)};
+                });
+                ++row;
+            }
+        });
+
+        MCSV_STATS_PHASE(&m_stats, convert);
+
+        // report the first error and stitch the chunks together in order
+        std::size_t offset = 0;
+        for(std::size_t i=0ul; i<chunks.size(); ++i)
+        {
+            if( errors[i] )
+                throw std::runtime_error(
+                    fmt::format("{}: cell '{}' in row {} of column '{}' cannot be converted to the column type",
+                                __func__, errors[i]->cell, offset + errors[i]->row, m_header[errors[i]->col]));
+
+            offset += std::get<0>(chunks[i]).size();
+        }
+
+        if( chunks.size() == 1 )
+        {
+            m_columns = std::move(chunks.front());
+        }
+        else
+        {
+            std::apply([&](auto &... column) { (column.reserve(offset), ...); }, m_columns);
+
+            for(auto &chunk : chunks)
+                append_columns(chunk, std::index_sequence_for<Ts...> {});
+        }
+
+        m_rows = offset;
+
+        MCSV_STATS_ADD(&m_stats, rows_parsed, m_rows);
+        MCSV_STATS_ADD(&m_stats, cells_parsed, m_rows * sizeof...(Ts));
+    }
+
+    schema_loader(const schema_loader &) = delete;
+    schema_loader &operator=(const schema_loader &) = delete;
+
+    /// @brief getter for the statistics of the loading and of the queries
+    stats_recorder &recorder() const
+    {
+        return m_stats;
+    }
+
+    /// @brief getter for the zone map, which is set by dataframe::build_index
+    zone_map_slot &zones() const
+    {
+        return m_zones;
+    }
+
+    /// @brief getter for the body of the csv-file, the cells are formatted as strings on access
+    const auto &data() const
+    {
+        return m_table;
+    }
+
+    /// @brief getter for the header of the csv-file
+    const auto &header() const
+    {
+        return m_header;
+    }
+
+    /// @brief getter for a map, which relates indices and column-headers
+    const auto &header_map() const
+    {
+        return m_header_map;
+    }
+
+    /// @brief number of rows
+    std::size_t rows() const
+    {
+        return m_rows;
+    }
+
+    /// @brief getter for the typed storage of column I
+    template<std::size_t I>
+    const auto &column() const
+    {
+        return std::get<I>(m_columns);
+    }
+
+    /// @brief getter for the typed storage of all columns
+    const auto &columns() const
+    {
+        return m_columns;
+    }
+
+    /// @brief calls fn(const S *data, std::size_t size) with the contiguous typed buffer of a
+    /// column, S is the stored type (see schema_storage_t)
+    template<class fn_t>
+    decltype(auto) visit_column(std::size_t col, fn_t &&fn) const
+    {
+        return dispatch(col, [&](const auto &column) {
+            return fn(column.data(), column.size());
+        });
+    }
+
+    /// @brief typed access to a cell, converted like in the columnar_loader
+    template<class T>
+    T get(std::size_t row, std::size_t col) const
+    {
+        return dispatch(col, [row](const auto &column) -> T {
+            using stored_t = typename std::decay_t<decltype(column)>::value_type;
+            return cast_stored<T, stored_t>(column[row]);
+        });
+    }
+
+    /// @brief access a specific cell in the csv file, formatted as std::string
+    auto at(std::size_t row, std::size_t col) const
+    {
+        if( m_rows <= row )
+            throw std::runtime_error(
+                fmt::format("{}: csv file has only {} rows, but row {} has been requested",
+                            __func__, m_rows, row));
+
+        if( m_header.size() <= col )
+            throw std::runtime_error(
+                fmt::format("{}: csv file has only {} cols, but col {} has been requested",
+                            __func__, m_header.size(), col));
+
+        return get<std::string>(row, col);
+    }
+
+private:
+    /// @brief moves the values of a chunk to the end of the columns
+    template<std::size_t... I>
+    void append_columns(columns_t &chunk, std::index_sequence<I...>)
+    {
+        (std::get<I>(m_columns).insert(std::get<I>(m_columns).end(),
+                                       std::make_move_iterator(std::get<I>(chunk).begin()),
+                                       std::make_move_iterator(std::get<I>(chunk).end())), ...);
+    }
+};
+
+template<class T>
+struct is_schema_loader : std::false_type {};
+
+template<class... Ts>
+struct is_schema_loader<schema_loader<Ts...>> : std::true_type {};
+
+template<class T>
+inline constexpr bool is_schema_loader_v = is_schema_loader<T>::value;
+
+/// @brief type trait, which checks if a loader provides typed access to its cells via get<T>(row, col)
+template<class loader_t, class T, class = void>
+struct has_typed_access : std::false_type {};
+
+template<class loader_t, class T>
+struct has_typed_access<loader_t, T, std::void_t<decltype(std::declval<const loader_t &>().template get<T>(0, 0))>> : std::true_type {};
+
+template<class loader_t, class T>
+inline constexpr bool has_typed_access_v = has_typed_access<loader_t, T>::value;
+
+/// @brief type trait, which checks if a loader provides its typed column buffers via visit_column(col, fn)
+struct column_access_probe
+{
+    template<class T>
+    int operator()(const T *, std::size_t) const { return 0; }
+};
+
+template<class loader_t, class = void>
+struct has_column_access : std::false_type {};
+
+template<class loader_t>
+struct has_column_access<loader_t, std::void_t<decltype(std::declval<const loader_t &>().visit_column(0, column_access_probe{}))>> : std::true_type {};
+
+template<class loader_t>
+inline constexpr bool has_column_access_v = has_column_access<loader_t>::value;
+
+/// @brief checks, if a loader records statistics (recorder())
+template<class loader_t, class = void>
+struct has_stats : std::false_type {};
+
+template<class loader_t>
+struct has_stats<loader_t, std::void_t<decltype(std::declval<const loader_t &>().recorder())>> : std::true_type {};
+
+template<class loader_t>
+inline constexpr bool has_stats_v = has_stats<loader_t>::value;
+
+/// @brief checks, if a loader records its zone map (zones())
+template<class loader_t, class = void>
+struct has_zones : std::false_type {};
+
+template<class loader_t>
+struct has_zones<loader_t, std::void_t<decltype(std::declval<const loader_t &>().zones())>> : std::true_type {};
+
+template<class loader_t>
+inline constexpr bool has_zones_v = has_zones<loader_t>::value;
+
+/// @brief checks, if a loader has dictionary-encoded columns (dictionary(col))
+template<class loader_t, class = void>
+struct has_dictionary_access : std::false_type {};
+
+template<class loader_t>
+struct has_dictionary_access<loader_t, std::void_t<decltype(std::declval<const loader_t &>().dictionary(0))>> : std::true_type {};
+
+template<class loader_t>
+inline constexpr bool has_dictionary_access_v = has_dictionary_access<loader_t>::value;
+
+/// @brief result of a filter for the rows of a block, as far as it is known from a zone map
+enum class zone_match : std::uint8_t
+{
+    none,       // no row passes
+    some,       // unknown, the cells must be tested
+    all         // all rows pass
+};
+
+/// @brief Zone map of a loader: the minimum, the maximum and the number of empty cells of each
+/// column for blocks of block_rows rows. The filters decide whole blocks from it, without converting
+/// their cells (see dataframe::build_index). Numeric bounds are only kept if all non-empty cells of
+/// a block are integers or floating point numbers (without NaN), text bounds for cells stored as strings.
+class zone_map
+{
+public:
+    /// @brief rows per block, a multiple of the 64 rows of a bitmap word
+    static constexpr std::size_t block_rows = 4096;
+    static constexpr std::size_t block_words = block_rows / 64;
+
+    /// @brief statistics of a column in a block
+    struct block
+    {
+        std::size_t nulls = 0;      // empty cells, which convert to 0
+        std::size_t values = 0;     // non-empty cells
+
+        bool integer = false;
+        std::int64_t int_min = 0, int_max = 0;
+
+        bool floating = false;
+        double float_min = 0.0, float_max = 0.0;
+
+        bool text = false;
+        std::string text_min, text_max;
+    };
+
+private:
+    std::size_t m_rows = 0;
+    std::size_t m_cols = 0;
+    std::vector<block> m_blocks;    // [col * blocks() + b]
+
+    template<class value_t>
+    static bool fits(std::int64_t v)
+    {
+        if constexpr( std::is_signed_v<value_t> )
+            return v >= static_cast<std::int64_t>(std::numeric_limits<value_t>::lowest()) &&
+                   v <= static_cast<std::int64_t>(std::numeric_limits<value_t>::max());
+        else
+            return v >= 0 && static_cast<std::uint64_t>(v) <= std::numeric_limits<value_t>::max();
+    }
+
+    /// @brief bounds of a block including the 0 of the empty cells
+    template<class value_t>
+    static std::pair<value_t, value_t> with_nulls(const block &b, value_t lo, value_t hi)
+    {
+        if( b.values == 0 )
+            return {value_t{}, value_t{}};
+        if( b.nulls > 0 )
+            return {std::min(lo, value_t{}), std::max(hi, value_t{})};
+
+        return {lo, hi};
+    }
+
+public:
+    /// @brief computes the statistics with compute(col, begin, end) -> block, in parallel over the blocks
+    template<class compute_fn_t>
+    zone_map(std::size_t rows, std::size_t cols, std::size_t threads, const compute_fn_t &compute) :
+        m_rows(rows),
+        m_cols(cols),
+        m_blocks(cols * blocks())
+    {
+        const auto n_blocks = blocks();
+        const auto parts = std::clamp(n_blocks / 16, std::size_t{1}, std::max(threads, std::size_t{1}));
+
+        run_parallel(parts, [&](std::size_t p) {
+            for(auto b = n_blocks * p / parts; b < n_blocks * (p + 1) / parts; ++b)
+                for(std::size_t col=0ul; col<m_cols; ++col)
+                    m_blocks[col * n_blocks + b] = compute(col, b * block_rows, std::min(m_rows, (b + 1) * block_rows));
+        });
+    }
+
+    std::size_t rows() const { return m_rows; }
+    std::size_t cols() const { return m_cols; }
+    std::size_t blocks() const { return (m_rows + block_rows - 1) / block_rows; }
+
+    /// @brief statistics of column col in block b, which contains the rows b*block_rows ...
+    const block &at(std::size_t col, std::size_t b) const
+    {
+        return m_blocks.at(col * blocks() + b);
+    }
+
+    /// @brief statistics of the cells cell(begin) ... cell(end-1), which are strings or
+    /// string views. Strings may be returned by value, e.g. by formatted rows.
+    template<class cell_fn_t>
+    static block from_cells(const cell_fn_t &cell, std::size_t begin, std::size_t end)
+    {
+        block b;
+        b.integer = b.floating = b.text = true;
+
+        for(auto i = begin; i < end; ++i)
+        {
+            decltype(auto) value = cell(i);
+            const std::string_view str = value;
+
+            if( i == begin || str < b.text_min )
+                b.text_min = str;
+            if( i == begin || str > b.text_max )
+                b.text_max = str;
+
+            if( str.empty() )
+            {
+                ++b.nulls;
+                continue;
+            }
+
+            const bool first = ( b.values++ == 0 );
+
+            std::int64_t v;
+            if( b.integer && (b.integer = try_convert(str, v)) )
+            {
+                b.int_min = first ? v : std::min(b.int_min, v);
+                b.int_max = first ? v : std::max(b.int_max, v);
+            }
+
+            double d;
+            if( b.floating && (b.floating = try_convert(str, d) && !std::isnan(d)) )
+            {
+                b.float_min = first ? d : std::min(b.float_min, d);
+                b.float_max = first ? d : std::max(b.float_max, d);
+            }
+        }
+
+        return b;
+    }
+
+    /// @brief statistics of the values data[begin] ... data[end-1] of a typed buffer. Booleans
+    /// (stored as std::uint8_t) get no bounds.
+    template<class T>
+    static block from_values(const T *data, std::size_t begin, std::size_t end)
+    {
+        if constexpr( std::is_same_v<T, std::string> )
+        {
+            return from_cells([data](std::size_t i) { return std::string_view(data[i]); }, begin, end);
+        }
+        else if constexpr( std::is_arithmetic_v<T> && !std::is_same_v<T, std::uint8_t> && !std::is_same_v<T, bool> )
+        {
+            block b;
+            b.values = end - begin;
+            b.integer = std::is_integral_v<T>;
+            b.floating = true;
+
+            for(auto i = begin; i < end; ++i)
+            {
+                const auto v = data[i];
+                const bool first = ( i == begin );
+
+                if constexpr( std::is_integral_v<T> )
+                {
+                    if( b.integer && (b.integer = fits<std::int64_t>(v)) )
+                    {
+                        b.int_min = first ? static_cast<std::int64_t>(v) : std::min(b.int_min, static_cast<std::int64_t>(v));
+                        b.int_max = first ? static_cast<std::int64_t>(v) : std::max(b.int_max, static_cast<std::int64_t>(v));
+                    }
+                }
+
+                const auto d = static_cast<double>(v);
+                if( b.floating && (b.floating = !std::isnan(d)) )
+                {
+                    b.float_min = first ? d : std::min(b.float_min, d);
+                    b.float_max = first ? d : std::max(b.float_max, d);
+                }
+            }
+
+            return b;
+        }
+        else
+        {
+            return block{};
+        }
+    }
+
+    /// @brief bounds of the cells of a block converted to value_t, if they are known. Integral types
+    /// use the integer bounds, if they fit, double the floating point bounds and strings the text bounds.
+    template<class value_t>
+    static std::optional<std::pair<value_t, value_t>> bounds(const block &b)
+    {
+        if constexpr( std::is_same_v<value_t, std::string> || std::is_same_v<value_t, std::string_view> )
+        {
+            if( b.text )
+                return std::pair<value_t, value_t>(b.text_min, b.text_max);
+        }
+        else if constexpr( std::is_integral_v<value_t> && !std::is_same_v<value_t, bool> )
+        {
+            if( b.integer && fits<value_t>(b.int_min) && fits<value_t>(b.int_max) )
+                return with_nulls(b, static_cast<value_t>(b.int_min), static_cast<value_t>(b.int_max));
+        }
+        else if constexpr( std::is_same_v<value_t, double> )
+        {
+            if( b.floating )
+                return with_nulls(b, b.float_min, b.float_max);
+        }
+
+        return std::nullopt;
+    }
+
+    /// @brief decides pred(cell, value) for a block, pred is one of the comparison operators
+    template<class pred_t, class value_t>
+    static zone_match match(const pred_t &, const block &b, const value_t &value)
+    {
+        const auto range = bounds<value_t>(b);
+
+        if( !range )
+            return zone_match::some;
+
+        const auto &[lo, hi] = *range;
+
+        if constexpr( std::is_same_v<pred_t, std::less<>> )
+            return hi < value ? zone_match::all : lo < value ? zone_match::some : zone_match::none;
+        else if constexpr( std::is_same_v<pred_t, std::less_equal<>> )
+            return hi <= value ? zone_match::all : lo <= value ? zone_match::some : zone_match::none;
+        else if constexpr( std::is_same_v<pred_t, std::greater<>> )
+            return lo > value ? zone_match::all : hi > value ? zone_match::some : zone_match::none;
+        else if constexpr( std::is_same_v<pred_t, std::greater_equal<>> )
+            return lo >= value ? zone_match::all : hi >= value ? zone_match::some : zone_match::none;
+        else if constexpr( std::is_same_v<pred_t, std::equal_to<>> )
+            return value < lo || hi < value ? zone_match::none :
+                   lo == value && hi == value ? zone_match::all : zone_match::some;
+        else
+            return zone_match::some;
+    }
+
+    /// @brief decides the membership of the cells of a block in a value_set
+    template<class value_t, class set_t>
+    static zone_match match_set(const block &b, const set_t &set)
+    {
+        const auto range = bounds<value_t>(b);
+
+        if( !range )
+            return zone_match::some;
+
+        const auto &[lo, hi] = *range;
+
+        if( !set.intersects(lo, hi) )
+            return zone_match::none;
+        if( lo == hi )
+            return set.contains(lo) ? zone_match::all : zone_match::none;
+
+        return zone_match::some;
+    }
+
+    /// @brief combines the matches of two filters of the same rows, which must both pass
+    static zone_match both(zone_match a, zone_match b)
+    {
+        if( a == zone_match::none || b == zone_match::none )
+            return zone_match::none;
+
+        return a == zone_match::all && b == zone_match::all ? zone_match::all : zone_match::some;
+    }
+
+    /// @brief the match of the block of a row, or some without matches
+    static zone_match row_match(const std::vector<zone_match> &matches, std::size_t row)
+    {
+        return matches.empty() ? zone_match::some : matches[row / block_rows];
+    }
+};
+
+/// @brief filter kernel, which evaluates pred(data[i]) for a whole column and packs the
+/// results into a bitmap. The inner loop over 64 rows has no branches, so it can be vectorized.
+/// Blocks, whose result is known from the zone map matches, are filled without evaluating pred.
+template<class T, class pred_t>
+std::vector<std::uint64_t> filter_kernel(const T *data, std::size_t size, const pred_t &pred,
+                                         const std::vector<zone_match> &matches = {})
+{
+    std::vector<std::uint64_t> bits((size + 63) / 64, 0);
+    const std::size_t full_words = size / 64;
+
+    for(std::size_t w=0ul; w<full_words; ++w)
+    {
+        if( !matches.empty() && matches[w / zone_map::block_words] != zone_match::some )
+        {
+            bits[w] = matches[w / zone_map::block_words] == zone_match::all ? ~std::uint64_t{0} : 0;
+            continue;
+        }
+
+        const T *block = data + w * 64;
+        std::uint64_t word = 0;
+
+        for(unsigned b=0; b<64; ++b)
+            word |= static_cast<std::uint64_t>(pred(block[b])) << b;
+
+        bits[w] = word;
+    }
+
+    for(std::size_t i=full_words*64; i<size; ++i)
+    {
+        const auto match = zone_map::row_match(matches, i);
+        const bool pass = match == zone_match::some ? pred(data[i]) : match == zone_match::all;
+        bits[i / 64] |= static_cast<std::uint64_t>(pass) << (i % 64);
+    }
+
+    return bits;
+}
+
+/// @brief hash function for std::tuple keys, combines the std::hash values of the elements
+struct tuple_hash
+{
+    template<class... Ts>
+    std::size_t operator()(const std::tuple<Ts...> &tuple) const
+    {
+        std::size_t seed = 0;
+
+        std::apply([&](const auto &... values) {
+            ((seed ^= std::hash<std::decay_t<decltype(values)>>{}(values) + std::size_t{0x9e3779b9} + (seed << 6) + (seed >> 2)), ...);
+        }, tuple);
+
+        return seed;
+    }
+};
+
+template<class T>
+struct is_tuple : std::false_type {};
+
+template<class... Ts>
+struct is_tuple<std::tuple<Ts...>> : std::true_type {};
+
+template<class T>
+inline constexpr bool is_tuple_v = is_tuple<T>::value;
+
+/// @brief Set of values for membership tests (is_in). Small sets are kept as sorted vector
+/// and searched with binary search, larger sets are moved into a hash set once they exceed
+/// small_size. Values are inserted one by one, so no intermediate container is needed.
+template<class T>
+class value_set
+{
+    using hash_t = std::conditional_t<is_tuple_v<T>, tuple_hash, std::hash<T>>;
+
+    std::vector<T> m_small;
+    std::unordered_set<T, hash_t> m_hashed;
+    bool m_use_hash = false;
+
+    // smallest and largest inserted value, for the zone maps
+    T m_lowest{}, m_highest{};
+
+public:
+    static constexpr std::size_t small_size = 32;
+
+    void insert(T value)
+    {
+        if( size() == 0 || value < m_lowest )
+            m_lowest = value;
+        if( size() == 0 || m_highest < value )
+            m_highest = value;
+
+        if( m_use_hash )
+        {
+            m_hashed.insert(std::move(value));
+            return;
+        }
+
+        const auto it = std::lower_bound(m_small.begin(), m_small.end(), value);
+
+        if( it != m_small.end() && *it == value )
+            return;
+
+        m_small.insert(it, std::move(value));
+
+        if( m_small.size() > small_size )
+        {
+            m_hashed.reserve(2 * small_size);
+            m_hashed.insert(std::make_move_iterator(m_small.begin()), std::make_move_iterator(m_small.end()));
+            m_small = std::vector<T>{};
+            m_use_hash = true;
+        }
+    }
+
+    /// @brief hint for the number of values, which will be inserted
+    void reserve(std::size_t n)
+    {
+        if( n > small_size )
+        {
+            m_hashed.reserve(n);
+            m_hashed.insert(std::make_move_iterator(m_small.begin()), std::make_move_iterator(m_small.end()));
+            m_small = std::vector<T>{};
+            m_use_hash = true;
+        }
+    }
+
+    bool contains(const T &value) const
+    {
+        if( m_use_hash )
+            return m_hashed.find(value) != m_hashed.end();
+        else
+            return std::binary_search(m_small.begin(), m_small.end(), value);
+    }
+
+    /// @brief returns false, if the set contains no value v with lo <= v <= hi. For a hashed set,
+    /// only the smallest and the largest value are checked.
+    template<class bound_t>
+    bool intersects(const bound_t &lo, const bound_t &hi) const
+    {
+        if( size() == 0 || hi < m_lowest || m_highest < lo )
+            return false;
+
+        if( m_use_hash )
+            return true;
+
+        const auto it = std::lower_bound(m_small.begin(), m_small.end(), lo);
+        return it != m_small.end() && !(hi < *it);
+    }
+
+    std::size_t size() const
+    {
+        return m_use_hash ? m_hashed.size() : m_small.size();
+    }
+};
+
+/// @brief Selection of the active rows of a dataframe. Depending on the selectivity, the rows
+/// are stored either as dense bitmap (one bit per row, processed 64 rows at a time) or as sparse
+/// sorted list of row indices. The number of active rows is cached, so count() is O(1).
+class row_selection
+{
+    std::size_t m_size = 0;
+    std::size_t m_count = 0;
+
+    bool m_sparse = false;
+    std::vector<std::uint64_t> m_bits;
+    std::vector<std::size_t> m_indices;
+
+    bool m_ordered = false;
+    std::vector<std::size_t> m_order;
+
+    /// @brief a sparse index list needs less memory than a bitmap below this fraction of active rows
+    static constexpr std::size_t sparse_fraction = 8 * sizeof(std::size_t);
+
+    static auto words(std::size_t size)
+    {
+        return (size + 63) / 64;
+    }
+
+    /// @brief switches to the representation, which fits the selectivity better
+    void adapt()
+    {
+        const bool sparse = m_count < m_size / sparse_fraction;
+
+        if( sparse && !m_sparse )
+        {
+            m_indices = indices();
+            m_bits = {};
+        }
+        else if( !sparse && m_sparse )
+        {
+            m_bits = bits();
+            m_indices = {};
+        }
+
+        m_sparse = sparse;
+    }
+
+    /// @brief the list, in which the active rows are visited, or nullptr for a dense unordered selection
+    const std::vector<std::size_t> *visiting_list() const
+    {
+        if( m_ordered )
+            return &m_order;
+        if( m_sparse )
+            return &m_indices;
+
+        return nullptr;
+    }
+
+    /// @brief creates an unordered selection from row indices in arbitrary order
+    static row_selection from_unsorted(std::size_t size, const std::vector<std::size_t> &rows)
+    {
+        std::vector<std::uint64_t> bits(words(size), 0);
+        for(auto row : rows)
+            bits[row / 64] |= std::uint64_t{1} << (row % 64);
+
+        return from_bits(size, std::move(bits));
+    }
+
+public:
+    /// @brief forward iterator over the indices of the active rows in visiting order
+    class const_iterator
+    {
+        const row_selection *m_sel;
+        const std::vector<std::size_t> *m_list;
+        std::size_t m_pos;          // index in m_list or word index
+        std::uint64_t m_word = 0;   // remaining bits of the current word
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::size_t;
+
+        const_iterator(const row_selection *sel, std::size_t pos) :
+            m_sel(sel), m_list(sel->visiting_list()), m_pos(pos)
+        {
+            if( !m_list )
+            {
+                for(; m_pos < m_sel->m_bits.size() && (m_word = m_sel->m_bits[m_pos]) == 0; ++m_pos);
+            }
+        }
+
+        std::size_t operator*() const
+        {
+            if( m_list )
+                return (*m_list)[m_pos];
+
+            return m_pos * 64 + count_trailing_zeros(m_word);
+        }
+
+        auto &operator++()
+        {
+            if( m_list )
+            {
+                ++m_pos;
+            }
+            else
+            {
+                m_word &= m_word - 1;
+
+                // skip empty words 64 rows at a time
+                while( m_word == 0 && ++m_pos < m_sel->m_bits.size() )
+                    m_word = m_sel->m_bits[m_pos];
+            }
+
+            return *this;
+        }
+
+        bool operator==(const const_iterator &other) const { return m_pos == other.m_pos && m_word == other.m_word; }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+    };
+
+    row_selection() = default;
+
+    /// @brief creates a selection of all rows 0 ... size-1
+    static row_selection all(std::size_t size)
+    {
+        std::vector<std::uint64_t> bits(words(size), ~std::uint64_t{0});
+
+        if( size % 64 != 0 )
+            bits.back() = (std::uint64_t{1} << (size % 64)) - 1;
+
+        return from_bits(size, std::move(bits));
+    }
+
+    /// @brief creates a selection from a bitmap, bit i of word j corresponds to row 64*j+i
+    static row_selection from_bits(std::size_t size, std::vector<std::uint64_t> bits)
+    {
+        if( bits.size() != words(size) )
+            throw std::runtime_error(fmt::format("{}: bitmap has wrong size", __func__));
+
+        row_selection sel;
+        sel.m_size = size;
+        sel.m_bits = std::move(bits);
+
+        for(auto word : sel.m_bits)
+            sel.m_count += popcount(word);
+
+        sel.adapt();
+        return sel;
+    }
+
+    /// @brief creates a selection from a sorted list of unique row indices
+    static row_selection from_indices(std::size_t size, std::vector<std::size_t> indices)
+    {
+        if( !indices.empty() && indices.back() >= size )
+            throw std::runtime_error(fmt::format("{}: row index out of range", __func__));
+
+        row_selection sel;
+        sel.m_size = size;
+        sel.m_count = indices.size();
+        sel.m_sparse = true;
+        sel.m_indices = std::move(indices);
+
+        sel.adapt();
+        return sel;
+    }
+
+    /// @brief number of rows of the underlying data
+    auto size() const { return m_size; }
+
+    /// @brief number of active rows
+    auto count() const { return m_count; }
+
+    /// @brief returns true, if the selection is stored as sparse index list
+    auto sparse() const { return m_sparse; }
+
+    /// @brief returns true, if the active rows are visited in an explicit order instead of increasing order
+    auto ordered() const { return m_ordered; }
+
+    /// @brief returns the same set of rows, which is visited in the given order
+    /// @param order permutation of the active rows
+    row_selection with_order(std::vector<std::size_t> order) const
+    {
+        if( order.size() != m_count )
+            throw std::runtime_error(fmt::format("{}: order must contain each active row once", __func__));
+
+        auto sel = *this;
+        sel.m_ordered = true;
+        sel.m_order = std::move(order);
+        return sel;
+    }
+
+    /// @brief checks if a row is active
+    bool test(std::size_t row) const
+    {
+        if( row >= m_size )
+            return false;
+
+        if( m_sparse )
+            return std::binary_search(m_indices.begin(), m_indices.end(), row);
+
+        return (m_bits[row / 64] >> (row % 64)) & 1;
+    }
+
+    auto begin() const { return const_iterator(this, 0); }
+    auto end() const
+    {
+        const auto list = visiting_list();
+        return const_iterator(this, list ? list->size() : m_bits.size());
+    }
+
+    /// @brief calls fn(row) for each active row in visiting order
+    template<class fn_t>
+    void for_each(fn_t &&fn) const
+    {
+        if( const auto list = visiting_list() )
+        {
+            for(auto row : *list)
+                fn(row);
+        }
+        else
+        {
+            for(std::size_t w=0ul; w<m_bits.size(); ++w)
+                for(auto word = m_bits[w]; word != 0; word &= word - 1)
+                    fn(w * 64 + count_trailing_zeros(word));
+        }
+    }
+
+    /// @brief rows per thread, below which for_each_parallel does not start more threads
+    static constexpr std::size_t min_parallel_rows = 1ul << 14;
+
+    /// @brief number of ranges, in which the active rows are split for up to threads threads
+    std::size_t parts(std::size_t threads) const
+    {
+        return std::clamp(m_count / min_parallel_rows, std::size_t{1}, std::max(threads, std::size_t{1}));
+    }
+
+    /// @brief calls fn(part, row, pos) for each active row, where pos is the position of the row
+    /// among the active rows (e.g. its index in an exported vector). The rows are split into parts
+    /// consecutive ranges in visiting order, which are processed concurrently. The start position of each
+    /// range is a prefix sum over the population counts of the preceding words of the bitmap.
+    template<class fn_t>
+    void for_each_part(std::size_t parts, const fn_t &fn) const
+    {
+        parts = std::max(parts, std::size_t{1});
+
+        if( parts == 1 )
+        {
+            std::size_t pos = 0;
+            for_each([&](std::size_t row) { fn(std::size_t{0}, row, pos++); });
+            return;
+        }
+
+        if( const auto list = visiting_list() )
+        {
+            run_parallel(parts, [&](std::size_t p) {
+                const auto end = list->size() * (p + 1) / parts;
+
+                for(auto k = list->size() * p / parts; k < end; ++k)
+                    fn(p, (*list)[k], k);
+            });
+
+            return;
+        }
+
+        std::vector<std::size_t> offsets(parts + 1, 0);
+        for(std::size_t p=0ul; p<parts; ++p)
+        {
+            offsets[p + 1] = offsets[p];
+
+            for(auto w = m_bits.size() * p / parts; w < m_bits.size() * (p + 1) / parts; ++w)
+                offsets[p + 1] += popcount(m_bits[w]);
+        }
+
+        run_parallel(parts, [&](std::size_t p) {
+            auto pos = offsets[p];
+
+            for(auto w = m_bits.size() * p / parts; w < m_bits.size() * (p + 1) / parts; ++w)
+                for(auto word = m_bits[w]; word != 0; word &= word - 1)
+                    fn(p, w * 64 + count_trailing_zeros(word), pos++);
+        });
+    }
+
+    /// @brief calls fn(row, pos) for each active row like for_each_part, with as many parts
+    /// as useful for the given number of threads
+    template<class fn_t>
+    void for_each_parallel(std::size_t threads, const fn_t &fn) const
+    {
+        for_each_part(parts(threads), [&](std::size_t, std::size_t row, std::size_t pos) {
+            fn(row, pos);
+        });
+    }
+
+    /// @brief returns the active rows as bitmap
+    std::vector<std::uint64_t> bits() const
+    {
+        if( !m_sparse )
+            return m_bits;
+
+        std::vector<std::uint64_t> bits(words(m_size), 0);
+        for(auto row : m_indices)
+            bits[row / 64] |= std::uint64_t{1} << (row % 64);
+
+        return bits;
+    }
+
+    /// @brief returns the active rows as sorted index list
+    std::vector<std::size_t> indices() const
+    {
+        if( m_sparse )
+            return m_indices;
+
+        std::vector<std::size_t> indices;
+        indices.reserve(m_count);
+        for(std::size_t w=0ul; w<m_bits.size(); ++w)
+            for(auto word = m_bits[w]; word != 0; word &= word - 1)
+                indices.push_back(w * 64 + count_trailing_zeros(word));
+
+        return indices;
+    }
+
+    /// @brief returns a selection, which contains only the active rows for which pred(row) is true.
+    /// An ordered selection keeps the order of the remaining rows.
+    template<class pred_t>
+    row_selection filter(pred_t &&pred) const
+    {
+        if( m_ordered )
+        {
+            std::vector<std::size_t> order;
+            std::copy_if(m_order.begin(), m_order.end(), std::back_inserter(order), pred);
+            return from_unsorted(m_size, order).with_order(std::move(order));
+        }
+
+        if( m_sparse )
+        {
+            std::vector<std::size_t> indices;
+            std::copy_if(m_indices.begin(), m_indices.end(), std::back_inserter(indices), pred);
+            return from_indices(m_size, std::move(indices));
+        }
+
+        std::vector<std::uint64_t> bits(m_bits.size(), 0);
+
+        for(std::size_t w=0ul; w<m_bits.size(); ++w)
+        {
+            std::uint64_t result = 0;
+
+            for(auto word = m_bits[w]; word != 0; word &= word - 1)
+            {
+                const auto bit = count_trailing_zeros(word);
+                result |= std::uint64_t{pred(w * 64 + bit)} << bit;
+            }
+
+            bits[w] = result;
+        }
+
+        return from_bits(m_size, std::move(bits));
+    }
+
+    /// @brief intersection of two selections of the same data, in the order of this or else of other
+    row_selection operator&(const row_selection &other) const
+    {
+        if( other.m_size != m_size )
+            throw std::runtime_error(fmt::format("{}: selections of different size", __func__));
+
+        // only the active rows of a sparse selection need to be checked
+        if( m_sparse || m_ordered )
+            return filter([&](std::size_t row) { return other.test(row); });
+        if( other.m_sparse || other.m_ordered )
+            return other.filter([&](std::size_t row) { return test(row); });
+
+        std::vector<std::uint64_t> bits(m_bits.size());
+        for(std::size_t w=0ul; w<bits.size(); ++w)
+            bits[w] = m_bits[w] & other.m_bits[w];
+
+        return from_bits(m_size, std::move(bits));
+    }
+
+    /// @brief difference of two selections of the same data (the rows, which are only in this)
+    row_selection without(const row_selection &other) const
+    {
+        if( other.m_size != m_size )
+            throw std::runtime_error(fmt::format("{}: selections of different size", __func__));
+
+        if( m_sparse || m_ordered )
+            return filter([&](std::size_t row) { return !other.test(row); });
+
+        auto bits = m_bits;
+        const auto other_bits = other.bits();
+
+        for(std::size_t w=0ul; w<bits.size(); ++w)
+            bits[w] &= ~other_bits[w];
+
+        return from_bits(m_size, std::move(bits));
+    }
+
+    /// @brief intersection with a bitmap of the same size, 64 rows at a time
+    row_selection operator&(const std::vector<std::uint64_t> &other_bits) const
+    {
+        if( other_bits.size() != words(m_size) )
+            throw std::runtime_error(fmt::format("{}: bitmap has wrong size", __func__));
+
+        if( m_sparse || m_ordered )
+            return filter([&](std::size_t row) { return (other_bits[row / 64] >> (row % 64)) & 1; });
+
+        auto bits = m_bits;
+        for(std::size_t w=0ul; w<bits.size(); ++w)
+            bits[w] &= other_bits[w];
+
+        return from_bits(m_size, std::move(bits));
+    }
+
+    /// @brief union of two selections of the same data, in increasing order
+    row_selection operator|(const row_selection &other) const
+    {
+        if( other.m_size != m_size )
+            throw std::runtime_error(fmt::format("{}: selections of different size", __func__));
+
+        if( m_sparse && other.m_sparse )
+        {
+            std::vector<std::size_t> indices;
+            indices.reserve(m_count + other.m_count);
+            std::set_union(m_indices.begin(), m_indices.end(), other.m_indices.begin(), other.m_indices.end(),
+                           std::back_inserter(indices));
+            return from_indices(m_size, std::move(indices));
+        }
+
+        auto bits = this->bits();
+        const auto other_bits = other.bits();
+
+        for(std::size_t w=0ul; w<bits.size(); ++w)
+            bits[w] |= other_bits[w];
+
+        return from_bits(m_size, std::move(bits));
+    }
+};
+
+/// @brief struct of arrays, which holds one contiguous array per column, as returned by
+/// dataframe::cols_to_soa. In contrast to std::vector<bool>, bool columns are real arrays.
+template<class... Ts>
+class soa
+{
+    std::size_t m_size = 0;
+    std::tuple<std::unique_ptr<Ts[]>...> m_columns;
+
+public:
+    /// @brief allocates the arrays for size rows, the elements are not initialized
+    explicit soa(std::size_t size) :
+        m_size(size),
+        m_columns(std::unique_ptr<Ts[]>(new Ts[size])...)
+    {
+    }
+
+    /// @brief number of rows
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /// @brief returns the array of the I-th column
+    template<std::size_t I>
+    auto *data()
+    {
+        return std::get<I>(m_columns).get();
+    }
+
+    /// @brief returns the array of the I-th column
+    template<std::size_t I>
+    const auto *data() const
+    {
+        return std::get<I>(m_columns).get();
+    }
+
+    /// @brief returns references to the elements of a row
+    auto operator[](std::size_t row) const
+    {
+        return std::apply([&](const auto &... columns) {
+            return std::tuple<const Ts &...>(columns[row]...);
+        }, m_columns);
+    }
+};
+
+/// @brief aggregation of a column for dataframe::groupby(...).agg(...), created by
+/// mcsv::sum, mcsv::mean, mcsv::count, mcsv::min and mcsv::max
+struct aggregation
+{
+    enum class kind_t { sum, mean, count, min, max };
+
+    kind_t kind;
+    std::string column;
+
+    /// @brief the name of the result column, e.g. "sum(x)"
+    std::string name() const
+    {
+        constexpr std::array<const char *, 5> names = {"sum", "mean", "count", "min", "max"};
+        return fmt::format("{}({})", names[static_cast<std::size_t>(kind)], column);
+    }
+};
+
+inline aggregation sum(std::string column) { return {aggregation::kind_t::sum, std::move(column)}; }
+inline aggregation mean(std::string column) { return {aggregation::kind_t::mean, std::move(column)}; }
+inline aggregation count() { return {aggregation::kind_t::count, ""}; }
+inline aggregation min(std::string column) { return {aggregation::kind_t::min, std::move(column)}; }
+inline aggregation max(std::string column) { return {aggregation::kind_t::max, std::move(column)}; }
+
+/// @brief running state of an aggregation over the values of a group
+struct aggregate_state
+{
+    double sum = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    std::size_t count = 0;
+
+    void add(double value)
+    {
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+        ++count;
+    }
+
+    void merge(const aggregate_state &other)
+    {
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        count += other.count;
+    }
+
+    double result(aggregation::kind_t kind) const
+    {
+        switch( kind )
+        {
+        case aggregation::kind_t::sum: return sum;
+        case aggregation::kind_t::mean: return sum / static_cast<double>(count);
+        case aggregation::kind_t::count: return static_cast<double>(count);
+        case aggregation::kind_t::min: return min;
+        case aggregation::kind_t::max: return max;
+        }
+
+        return 0.0;
+    }
+};
+
+/// @brief open-addressing hash index (linear probing) from keys to the indices of the groups.
+/// The slots only store the group index, the keys are stored contiguously by the caller.
+template<class key_t>
+class group_index
+{
+    // group index + 1, 0 marks an empty slot
+    std::vector<std::uint32_t> m_slots;
+
+    /// @brief hash with mixed bits, because std::hash of integers is the identity
+    static std::uint64_t hash(const key_t &key)
+    {
+        std::uint64_t h = std::hash<key_t>{}(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    void insert_slot(std::size_t group, const key_t &key)
+    {
+        const auto mask = m_slots.size() - 1;
+
+        auto i = hash(key) & mask;
+        while( m_slots[i] != 0 )
+            i = (i + 1) & mask;
+
+        m_slots[i] = static_cast<std::uint32_t>(group + 1);
+    }
+
+public:
+    /// @brief returns the group of key, or keys.size() if key is not in the index
+    std::size_t find(const key_t &key, const std::vector<key_t> &keys) const
+    {
+        if( m_slots.empty() )
+            return keys.size();
+
+        const auto mask = m_slots.size() - 1;
+
+        for(auto i = hash(key) & mask; ; i = (i + 1) & mask)
+        {
+            const auto slot = m_slots[i];
+
+            if( slot == 0 )
+                return keys.size();
+
+            if( keys[slot - 1] == key )
+                return slot - 1;
+        }
+    }
+
+    /// @brief returns the group of key, appends key to keys if it is a new group
+    std::size_t find_or_insert(const key_t &key, std::vector<key_t> &keys)
+    {
+        // the load factor is kept below 1/2
+        if( 2 * (keys.size() + 1) > m_slots.size() )
+        {
+            m_slots.assign(std::max(std::size_t{64}, 2 * m_slots.size()), 0);
+
+            for(std::size_t g=0ul; g<keys.size(); ++g)
+                insert_slot(g, keys[g]);
+        }
+
+        const auto mask = m_slots.size() - 1;
+
+        for(auto i = hash(key) & mask; ; i = (i + 1) & mask)
+        {
+            const auto slot = m_slots[i];
+
+            if( slot == 0 )
+            {
+                keys.push_back(key);
+                m_slots[i] = static_cast<std::uint32_t>(keys.size());
+                return keys.size() - 1;
+            }
+
+            if( keys[slot - 1] == key )
+                return slot - 1;
+        }
+    }
+};
+
+/// @brief appends a cell to a csv output buffer of the given dialect. The cell is only quoted,
+/// if it contains a delimiter, quote or line break, if it starts or ends with a whitespace,
+/// which the tokenizer of the dialect would trim, or if it starts with the comment character.
+/// Quotes inside quoted cells are doubled.
+/// @throw std::runtime_error, if the cell must be quoted, but the dialect has no quote
+template<class dialect_t = dialect<>>
+void append_csv_cell(std::string &out, std::string_view cell)
+{
+    constexpr auto &classes = char_class_table<dialect_t>;
+    constexpr char quote_char = dialect_t::quote;
+
+    // branchless scan, which the compiler can vectorize
+    bool quote = !cell.empty() && (classes[static_cast<unsigned char>(cell.front())] == char_class::space ||
+                                   classes[static_cast<unsigned char>(cell.back())] == char_class::space ||
+                                   (dialect_t::comment != '\0' && cell.front() == dialect_t::comment));
+    for(auto c : cell)
+        quote |= (c == dialect_t::delimiter) | (quote_char != '\0' && c == quote_char) | (c == '\n') | (c == '\r');
+
+    if( !quote )
+    {
+        out += cell;
+        return;
+    }
+
+    if constexpr( quote_char == '\0' )
+    {
+        throw std::runtime_error(fmt::format("{}: cell '{}' must be quoted, but the dialect has no quote", __func__, cell));
+    }
+    else
+    {
+        out += quote_char;
+        for(std::size_t pos = 0; pos < cell.size(); )
+        {
+            const auto next = std::min(cell.find(quote_char, pos), cell.size());
+            out += cell.substr(pos, next - pos);
+
+            if( next < cell.size() )
+                out.append(2, quote_char);
+
+            pos = next + 1;
+        }
+        out += quote_char;
+    }
+}
+
+/// @brief appends a number to a csv output buffer with std::to_chars, floating point
+/// numbers in their shortest representation, which reads back to the same value
+template<class T>
+void append_csv_number(std::string &out, T value)
+{
+#if !defined(__cpp_lib_to_chars)
+    // floating point std::to_chars is missing in older standard libraries
+    if constexpr( std::is_floating_point_v<T> )
+    {
+        fmt::format_to(std::back_inserter(out), "{}", value);
+        return;
+    }
+#endif
+
+    std::array<char, 32> chars;
+    const auto result = std::to_chars(chars.data(), chars.data() + chars.size(), value);
+    out.append(chars.data(), result.ptr);
+}
+
+/// @brief maps an arithmetic value to an unsigned key with the same order, for radix sorting.
+/// Floating point numbers are ordered by their bits, with all bits of negative numbers flipped.
+template<class T>
+std::uint64_t radix_key(T value)
+{
+    if constexpr( std::is_floating_point_v<T> )
+    {
+        const double d = value;
+        std::uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+
+        return (bits >> 63) ? ~bits : bits | (std::uint64_t{1} << 63);
+    }
+    else if constexpr( std::is_signed_v<T> )
+    {
+        const std::int64_t i = value;
+        return static_cast<std::uint64_t>(i) ^ (std::uint64_t{1} << 63);
+    }
+    else
+    {
+        return value;
+    }
+}
+
+/// @brief stable LSD radix sort of rows by keys, 8 bits per pass. The histograms of all passes
+/// are counted in one read over the keys, passes in which all keys have the same digit are skipped.
+inline void radix_sort(std::vector<std::uint64_t> &keys, std::vector<std::size_t> &rows)
+{
+    constexpr std::size_t passes = sizeof(std::uint64_t);
+    const auto n = keys.size();
+
+    std::vector<std::array<std::size_t, 256>> counts(passes);
+    for(auto &count : counts)
+        count.fill(0);
+
+    for(auto key : keys)
+        for(std::size_t d=0ul; d<passes; ++d)
+            ++counts[d][(key >> (8 * d)) & 0xff];
+
+    std::vector<std::uint64_t> sorted_keys(n);
+    std::vector<std::size_t> sorted_rows(n);
+
+    for(std::size_t d=0ul; d<passes; ++d)
+    {
+        auto &count = counts[d];
+
+        if( std::find(count.begin(), count.end(), n) != count.end() )
+            continue;
+
+        std::size_t offset = 0;
+        for(auto &c : count)
+        {
+            const auto digit_count = c;
+            c = offset;
+            offset += digit_count;
+        }
+
+        for(std::size_t i=0ul; i<n; ++i)
+        {
+            auto &pos = count[(keys[i] >> (8 * d)) & 0xff];
+            sorted_keys[pos] = keys[i];
+            sorted_rows[pos] = rows[i];
+            ++pos;
+        }
+
+        keys.swap(sorted_keys);
+        rows.swap(sorted_rows);
+    }
+}
+
+template<typename loader_t, int C = -1>
+class dataframe;
+
+template<class left_loader_t, int LC, class right_loader_t, int RC>
+class join_result;
+
+/// @brief rows of a dataframe grouped by a key column, obtained by dataframe::groupby
+template<class loader_t, int C, class key_t>
+class grouped_dataframe
+{
+    dataframe<loader_t, C> m_df;
+    std::string m_key;
+    std::size_t m_threads;
+
+public:
+    grouped_dataframe(dataframe<loader_t, C> df, std::string key, std::size_t threads) :
+        m_df(std::move(df)),
+        m_key(std::move(key)),
+        m_threads(threads)
+    {
+    }
+
+    /// @brief aggregates the values of each group
+    /// @param aggs aggregations like mcsv::sum("x"), the values are converted to double
+    /// @return default_dataframe with the key column and one column per aggregation (e.g.
+    /// "sum(x)"), which contains one row per group, sorted by the key
+    template<class... aggs_t>
+    auto agg(const aggs_t &... aggs) const
+    {
+        return m_df.template aggregate<key_t>(m_key, std::vector<aggregation>{aggs...}, m_threads);
+    }
+};
+
+/// @brief Deferred row filter, built by comparisons on dataframe::lazy() and combined with
+/// &&, || and !. Nothing is evaluated until the expression is passed to select_rows(), then
+/// the whole predicate tree is evaluated in a single pass over the rows, short-circuiting per
+/// row, and only one row selection is allocated.
+/// @tparam pred_t row predicate, called as pred(std::size_t row)
+template<class loader_t, class pred_t>
+class filter_expr
+{
+    template<typename floader_t, class fpred_t>
+    friend class filter_expr;
+
+    std::shared_ptr<loader_t> m_loader;
+
+    // rows, on which the predicate is evaluated (the rows of the dataframe, on which lazy() was called)
+    std::shared_ptr<const row_selection> m_row_sel;
+    pred_t m_pred;
+
+    template<class other_pred_t>
+    void throw_if_different_file(const filter_expr<loader_t, other_pred_t> &expr) const
+    {
+        if( expr.m_loader != m_loader )
+            throw std::runtime_error(
+                fmt::format("{}: cannot logically combine expressions of different csv-files", __func__)
+            );
+    }
+
+    template<class other_pred_t>
+    static auto make(std::shared_ptr<loader_t> loader, std::shared_ptr<const row_selection> row_sel, other_pred_t pred)
+    {
+        return filter_expr<loader_t, other_pred_t>(std::move(loader), std::move(row_sel), std::move(pred));
+    }
+
+public:
+    filter_expr(std::shared_ptr<loader_t> loader, std::shared_ptr<const row_selection> row_sel, pred_t pred) :
+        m_loader(std::move(loader)),
+        m_row_sel(std::move(row_sel)),
+        m_pred(std::move(pred))
+    {
+    }
+
+    /// @brief evaluates the predicate for a single row
+    bool operator()(std::size_t row) const
+    {
+        return m_pred(row);
+    }
+
+    /// @brief evaluates the expression in one pass over the rows
+    row_selection evaluate() const
+    {
+        return m_row_sel->filter(m_pred);
+    }
+
+    const auto &loader() const
+    {
+        return m_loader;
+    }
+
+    /// @brief logical AND, the second predicate is only evaluated if the first one is true
+    template<class other_pred_t>
+    auto operator&&(const filter_expr<loader_t, other_pred_t> &expr) const
+    {
+        throw_if_different_file(expr);
+
+        auto rows = m_row_sel == expr.m_row_sel ? m_row_sel : std::make_shared<const row_selection>(*m_row_sel & *expr.m_row_sel);
+
+        return make(m_loader, std::move(rows), [a = m_pred, b = expr.m_pred](std::size_t i) {
+            return a(i) && b(i);
+        });
+    }
+
+    /// @brief logical OR, the second predicate is only evaluated if the first one is false.
+    /// Each predicate only holds on the rows of its own expression.
+    template<class other_pred_t>
+    auto operator||(const filter_expr<loader_t, other_pred_t> &expr) const
+    {
+        throw_if_different_file(expr);
+
+        // if both expressions have the same rows, no row test is needed
+        const bool same = ( m_row_sel == expr.m_row_sel );
+        auto rows = same ? m_row_sel : std::make_shared<const row_selection>(*m_row_sel | *expr.m_row_sel);
+        auto sa = same ? nullptr : m_row_sel;
+        auto sb = same ? nullptr : expr.m_row_sel;
+
+        return make(m_loader, std::move(rows), [a = m_pred, b = expr.m_pred, sa, sb](std::size_t i) {
+            return ( ( !sa || sa->test(i) ) && a(i) ) || ( ( !sb || sb->test(i) ) && b(i) );
+        });
+    }
+
+    /// @brief logical NOT with respect to the rows of the expression
+    auto operator!() const
+    {
+        return make(m_loader, m_row_sel, [a = m_pred](std::size_t i) {
+            return !a(i);
+        });
+    }
+};
+
+/// @brief columns of a dataframe, whose comparisons build a filter_expr instead of
+/// being evaluated immediately. Obtained by dataframe::lazy().
+template<class loader_t, int C>
+class column_expr
+{
+    dataframe<loader_t, C> m_df;
+
+public:
+    column_expr(dataframe<loader_t, C> df) :
+        m_df(std::move(df))
+    {
+    }
+
+    template<class tuple_t>
+    auto operator==(const tuple_t &tuple) const { return m_df.lazy_comparison(std::equal_to{}, tuple); }
+
+    template<class tuple_t>
+    auto operator!=(const tuple_t &tuple) const { return !m_df.lazy_comparison(std::equal_to{}, tuple); }
+
+    template<class tuple_t>
+    auto operator<(const tuple_t &tuple) const { return m_df.lazy_comparison(std::less{}, tuple); }
+
+    template<class tuple_t>
+    auto operator<=(const tuple_t &tuple) const { return m_df.lazy_comparison(std::less_equal{}, tuple); }
+
+    template<class tuple_t>
+    auto operator>(const tuple_t &tuple) const { return m_df.lazy_comparison(std::greater{}, tuple); }
+
+    template<class tuple_t>
+    auto operator>=(const tuple_t &tuple) const { return m_df.lazy_comparison(std::greater_equal{}, tuple); }
+
+    /// @brief deferred version of dataframe::is_in, the set of values is built immediately
+    template<typename iterable_t,
+             typename = decltype(std::begin(std::declval<iterable_t>())),
+             typename = decltype(std::end(std::declval<iterable_t>()))>
+    auto is_in(const iterable_t &iterable) const
+    {
+        return m_df.lazy_is_in(iterable);
+    }
+};
+
+/// @brief Dataframe class, which allows easy manipulation of rows and columns.
+/// When a manipulating operation is used, a new object is created with updated
+/// column- and row mask. No data are copied, since they are stored in a shared pointer.
+/// @tparam loader_t implementation of the data storage
+/// @tparam C non-type-template-parameter which stores the column-count or -1
+template<typename loader_t, int C>
+class dataframe
+{
+    std::shared_ptr<loader_t> m_loader;
+
+    // active rows and (sorted) indices of the active columns. Shared between dataframes,
+    // so e.g. selecting columns does not copy the row selection.
+    std::shared_ptr<const row_selection> m_row_sel;
+    std::shared_ptr<const std::vector<std::size_t>> m_col_idx;
+
+    // zone map of the loader, shared by all dataframes over it (see loader_zones)
+    std::shared_ptr<zone_map_slot> m_zones;
+
+    /// @brief returns the zone map slot recorded by the loader, which keeps the loader alive.
+    /// Loaders without one get an own slot, which is shared by the dataframes derived from this one.
+    static std::shared_ptr<zone_map_slot> loader_zones(const std::shared_ptr<loader_t> &loader)
+    {
+        if constexpr( has_zones_v<loader_t> )
+            return std::shared_ptr<zone_map_slot>(loader, &loader->zones());
+        else
+            return std::make_shared<zone_map_slot>();
+    }
+
+public:
+    /// @brief no default constructor
+    dataframe() = delete;
+
+    dataframe(std::filesystem::path path) :
+        dataframe(std::make_shared<loader_t>(path))
+    {
+    }
+
+    /// @brief constructs the loader with options, e.g. for parallel loading
+    dataframe(std::filesystem::path path, const load_options &options) :
+        dataframe(std::make_shared<loader_t>(path, options))
+    {
+    }
+
+    /// @brief constructs a dataframe over all rows and columns of an existing loader
+    dataframe(std::shared_ptr<loader_t> loader) :
+        m_loader(loader),
+        m_row_sel(std::make_shared<const row_selection>(row_selection::all(m_loader->data().size()))),
+        m_col_idx(std::make_shared<const std::vector<std::size_t>>(all_cols(m_loader->header().size()))),
+        m_zones(loader_zones(m_loader))
+    {
+        if( C != -1 && cols() != C )
+            throw std::runtime_error(
+                fmt::format("{}: compile-time column number (which is {}) mismatches run-time column number (which is {})",
+                            __func__, C, cols())
+            );
+    }
+
+private:
+    template<typename floader_t, int FC>
+    friend class dataframe;
+
+    template<typename floader_t, int FC>
+    friend class column_expr;
+
+    template<typename floader_t, int FC, class fkey_t>
+    friend class grouped_dataframe;
+
+    template<class fleft_loader_t, int FLC, class fright_loader_t, int FRC>
+    friend class join_result;
+
+    /// @brief private constructor, used dataframe-manipulation
+    dataframe(std::shared_ptr<loader_t> loader,
+              std::shared_ptr<const row_selection> row_sel,
+              std::shared_ptr<const std::vector<std::size_t>> col_idx,
+              std::shared_ptr<zone_map_slot> zones) :
+        m_loader(loader),
+        m_row_sel(row_sel),
+        m_col_idx(col_idx),
+        m_zones(zones)
+    {
+        if( C != -1 && cols() != C )
+            throw std::runtime_error(
+                fmt::format("{}: compile-time column number (which is {}) mismatches run-time column number (which is {})",
+                            __func__, C, cols())
+            );
+    }
+
+    /// @brief private constructor, used dataframe-manipulation with a new row selection
+    dataframe(std::shared_ptr<loader_t> loader,
+              row_selection row_sel,
+              std::shared_ptr<const std::vector<std::size_t>> col_idx,
+              std::shared_ptr<zone_map_slot> zones) :
+        dataframe(loader, std::make_shared<const row_selection>(std::move(row_sel)), col_idx, zones)
+    {
+    }
+
+    /// @brief returns the indices 0 ... n-1
+    static auto all_cols(std::size_t n)
+    {
+        std::vector<std::size_t> cols(n);
+        std::iota(cols.begin(), cols.end(), std::size_t{0});
+        return cols;
+    }
+
+    /// @brief iterator, which iterates over the elements of a container, given by an
+    /// iterator over their indices (the active rows or columns)
+    template<class container_t, class index_iterator_t>
+    struct indexed_iterator
+    {
+        const container_t *container;
+        index_iterator_t index_it;
+
+        bool operator != (const indexed_iterator & other) const {
+            return index_it != other.index_it;
+        }
+        void operator ++ () {
+            ++index_it;
+        }
+        decltype(auto) operator *  () const {
+            return (*container)[*index_it];
+        }
+    };
+
+    /// @brief helper-type, which enables range-based for-loops for indexed iterators.
+    /// Keeps the indices alive, even if the dataframe was a temporary.
+    template<class iterator_t>
+    struct iterable_wrapper
+    {
+        const iterator_t begin_it, end_it;
+        const std::shared_ptr<const void> keep_alive;
+
+        auto begin() {
+            return begin_it;
+        }
+        auto end() {
+            return end_it;
+        }
+    };
+
+    /// @brief Static, private function which creates an indexed iterable
+    /// @param c Container over which will be iterated
+    /// @param indices indices of the elements of the container, which are iterated
+    template<class container_t, class indices_t>
+    static auto indexed_iterable(const container_t &c,
+                                 const std::shared_ptr<const indices_t> &indices)
+    {
+        using iterator_t = indexed_iterator<container_t, typename indices_t::const_iterator>;
+
+        return iterable_wrapper<iterator_t> {
+            iterator_t{ &c, indices->begin() }, iterator_t{ &c, indices->end() }, indices
+        };
+    }
+
+    /// @brief returns a cell converted to T. Uses the typed storage of the loader
+    /// (e.g. columnar_loader) if available, otherwise the cell string is converted.
+    template<class T>
+    auto cell(std::size_t row, std::size_t col) const
+    {
+        using value_t = std::remove_cv_t<std::remove_reference_t<T>>;
+
+        if constexpr( has_typed_access_v<loader_t, value_t> )
+            return m_loader->template get<value_t>(row, col);
+        else
+            return convert<value_t>(m_loader->data()[row][col]);
+    }
+
+    /// @brief returns the indices of the active columns
+    const auto &active_cols() const
+    {
+        return *m_col_idx;
+    }
+
+    /// @brief statistics of the rows begin ... end-1 of a column for the zone map, from the typed
+    /// buffer of the loader if available, otherwise from the cell strings
+    zone_map::block block_stats(std::size_t col, std::size_t begin, std::size_t end) const
+    {
+        if constexpr( has_dictionary_access_v<loader_t> )
+        {
+            if( const auto *dict = m_loader->dictionary(col) )
+                return zone_map::from_cells([dict](std::size_t i) -> decltype(auto) { return (*dict)[i]; }, begin, end);
+        }
+
+        if constexpr( has_column_access_v<loader_t> )
+        {
+            return m_loader->visit_column(col, [&](const auto *data, std::size_t) {
+                return zone_map::from_values(data, begin, end);
+            });
+        }
+        else
+        {
+            const auto &table = m_loader->data();
+            return zone_map::from_cells([&](std::size_t i) -> decltype(auto) { return table[i][col]; }, begin, end);
+        }
+    }
+
+    /// @brief returns the stats_recorder of the loader, or nullptr if the loader has none
+    stats_recorder *recorder() const
+    {
+        if constexpr( has_stats_v<loader_t> )
+            return &m_loader->recorder();
+        else
+            return nullptr;
+    }
+
+    /// @brief returns a dataframe with the rows of a filter result and records its statistics
+    template<int NC>
+    auto filtered(row_selection new_row_sel) const
+    {
+        MCSV_STATS_ADD(recorder(), filtered_rows, m_row_sel->count());
+        MCSV_STATS_ADD(recorder(), passed_rows, new_row_sel.count());
+
+        return dataframe<loader_t, NC>(m_loader, std::move(new_row_sel), m_col_idx, m_zones);
+    }
+
+    /// @brief returns the index of a column of the csv-file
+    std::size_t column_index(const std::string &name) const
+    {
+        const auto found = m_loader->header_map().find(name);
+
+        if( found == m_loader->header_map().end() )
+            throw std::runtime_error(fmt::format("{}: csv-file has no column '{}'", __func__, name));
+
+        return found->second;
+    }
+
+    /// @brief helper function, which converts a std::tuple,
+    /// which is only allowed to contain std::strings, to a
+    /// std::array of std::strings
+    template<class tuple_t, std::size_t... idx>
+    static auto string_tuple_to_array(const tuple_t &tuple,
+                                      std::index_sequence<idx...>)
+    {
+        static_assert( std::tuple_size_v<tuple_t> == sizeof...(idx), "tuple size mismatches index_sequence size");
+
+        std::array<std::string, sizeof...(idx)> array;
+        ((std::get<idx>(array) = std::get<idx>(tuple)), ...);
+        return array;
+    }
+
+    /// @brief static, private helber-function to implement the comparison operators.
+    /// @tparam tuple_t instance of std::tuple. The cells are converted in the contained types.
+    /// @param pred predicate, which is used to compare (std::less, std::equal_to, ...)
+    /// @param tuple tuple which will be compared to the row
+    /// @param row index of the row, which will be compared to tuple after conversion to the specific types
+    /// @param cols indices of the active columns
+    template<class pred_t, class tuple_t, std::size_t... idx>
+    bool compare_tuple_and_row(const pred_t &pred, const tuple_t &tuple, std::size_t row,
+                               const std::vector<std::size_t> &cols,
+                               std::index_sequence<idx...>) const
+    {
+        static_assert( std::tuple_size_v<tuple_t> == sizeof...(idx),
+                       "tuple and index_sequence have different size" );
+
+        //  cell(row, cols[0]) == tuple[0]  &&  cell(row, cols[1]) == tuple[1]  &&  ...
+        return (( pred( cell<std::tuple_element_t<idx, tuple_t>>(row, cols[idx]), std::get<idx>(tuple) ) ) && ...);
+    }
+
+    /// @brief evaluates pred(cell) for a whole column with a filter kernel over the typed buffer
+    /// of the loader, if the stored type can be converted to value_t without string conversion
+    /// @param matches results of the blocks known from the zone map, which are not evaluated
+    /// @return bitmap of the result, or std::nullopt if no suitable typed buffer exists
+    template<class value_t, class pred_t>
+    std::optional<std::vector<std::uint64_t>> column_kernel(const pred_t &pred, std::size_t col,
+                                                            const std::vector<zone_match> &matches = {}) const
+    {
+        // for dictionary-encoded columns, pred is evaluated once per distinct value
+        // and the kernel only looks up the result for the codes
+        if constexpr( has_dictionary_access_v<loader_t> )
+        {
+            if( const auto *dict = m_loader->dictionary(col) )
+            {
+                std::vector<std::uint8_t> hits(dict->pool.size());
+
+                for(std::size_t k=0ul; k<hits.size(); ++k)
+                {
+                    if constexpr( std::is_same_v<value_t, std::string> )
+                        hits[k] = pred(dict->pool[k]);
+                    else
+                        hits[k] = pred(convert<value_t>(dict->pool[k]));
+                }
+
+                return filter_kernel(dict->data(), dict->size(), [&](std::uint32_t code) { return hits[code] != 0; }, matches);
+            }
+        }
+
+        if constexpr( has_column_access_v<loader_t> )
+        {
+            return m_loader->visit_column(col, [&](const auto *data, std::size_t size) -> std::optional<std::vector<std::uint64_t>> {
+                using stored_t = std::remove_cv_t<std::remove_pointer_t<decltype(data)>>;
+
+                // same conversion as in the typed cell access of the loader
+                if constexpr( std::is_same_v<stored_t, value_t> )
+                    return filter_kernel(data, size, [&](const stored_t &s) { return pred(s); }, matches);
+                else if constexpr( std::is_arithmetic_v<stored_t> && std::is_arithmetic_v<value_t> )
+                    return filter_kernel(data, size, [&](const stored_t &s) { return pred(cast_stored<value_t, stored_t>(s)); }, matches);
+                else
+                    return std::nullopt;
+            });
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+
+    /// @brief helper-function, which applies column_kernel to all columns of a tuple comparison
+    /// @return false, if at least one column has no suitable typed buffer
+    template<class pred_t, class tuple_t, std::size_t... idx>
+    bool tuple_column_kernels(const pred_t &pred, const tuple_t &tuple,
+                              const std::vector<std::size_t> &cols,
+                              const std::vector<zone_match> &matches,
+                              std::array<std::vector<std::uint64_t>, sizeof...(idx)> &results,
+                              std::index_sequence<idx...>) const
+    {
+        const auto apply = [&](auto &result, auto &&bits) {
+            if( !bits )
+                return false;
+            result = std::move(*bits);
+            return true;
+        };
+
+        return ( apply(std::get<idx>(results), column_kernel_for_value(pred, std::get<idx>(tuple), cols[idx], matches)) && ... );
+    }
+
+    /// @brief column_kernel for the comparison pred(cell, value)
+    template<class V, class pred_t>
+    auto column_kernel_for_value(const pred_t &pred, const V &value, std::size_t col,
+                                 const std::vector<zone_match> &matches) const
+    {
+        using value_t = std::remove_cv_t<std::remove_reference_t<V>>;
+
+        return column_kernel<value_t>([&](const value_t &v) { return pred(v, value); }, col, matches);
+    }
+
+    /// @brief decides the blocks of the zone map for the comparison of the active columns with a tuple
+    /// @return one match per block, or an empty vector without zone map
+    template<class pred_t, class tuple_t, std::size_t... idx>
+    std::vector<zone_match> tuple_zone_matches(const pred_t &pred, const tuple_t &tuple,
+                                               const std::vector<std::size_t> &cols,
+                                               std::index_sequence<idx...>) const
+    {
+        const auto zones = m_zones->get();
+
+        if( !zones )
+            return {};
+
+        std::vector<zone_match> matches(zones->blocks(), zone_match::all);
+
+        for(std::size_t b=0ul; b<matches.size(); ++b)
+            ((matches[b] = zone_map::both(matches[b], zone_map::match(pred, zones->at(cols[idx], b), std::get<idx>(tuple)))), ...);
+
+        return matches;
+    }
+
+    /// @brief decides the blocks of the zone map for the membership of a column in a set
+    /// @return one match per block, or an empty vector without zone map
+    template<class key_t>
+    std::vector<zone_match> set_zone_matches(const value_set<key_t> &set, std::size_t col) const
+    {
+        const auto zones = m_zones->get();
+
+        if( !zones )
+            return {};
+
+        std::vector<zone_match> matches(zones->blocks());
+
+        for(std::size_t b=0ul; b<matches.size(); ++b)
+            matches[b] = zone_map::match_set<key_t>(zones->at(col, b), set);
+
+        return matches;
+    }
+
+    /// @brief returns the result of a filter, if the zone map decides it for all blocks
+    std::optional<row_selection> decided_by_zones(const std::vector<zone_match> &matches) const
+    {
+        if( matches.empty() )
+            return std::nullopt;
+
+        std::size_t decided = 0;
+        for(std::size_t b=0ul; b<matches.size(); ++b)
+            if( matches[b] != zone_match::some )
+                decided += std::min(zone_map::block_rows, m_row_sel->size() - b * zone_map::block_rows);
+
+        MCSV_STATS_ADD(recorder(), skipped_rows, decided);
+
+        if( std::all_of(matches.begin(), matches.end(), [](zone_match m) { return m == zone_match::none; }) )
+            return row_selection::from_indices(m_row_sel->size(), {});
+        if( std::all_of(matches.begin(), matches.end(), [](zone_match m) { return m == zone_match::all; }) )
+            return *m_row_sel;
+
+        return std::nullopt;
+    }
+
+    /// @brief helper-function, which returns the tuple of cells of a row
+    template<class key_t, std::size_t... idx>
+    key_t tuple_row_key(std::size_t row, const std::vector<std::size_t> &cols,
+                        std::index_sequence<idx...>) const
+    {
+        return key_t(cell<std::tuple_element_t<idx, key_t>>(row, cols[idx])...);
+    }
+
+    /// @brief returns the key of a row for membership tests, i.e. a single cell
+    /// or a std::tuple of cells
+    template<class key_t>
+    key_t row_key(std::size_t row, const std::vector<std::size_t> &cols) const
+    {
+        if constexpr( is_tuple_v<key_t> )
+            return tuple_row_key<key_t>(row, cols, std::make_index_sequence<std::tuple_size_v<key_t>> {});
+        else
+            return cell<key_t>(row, cols.front());
+    }
+
+    /// @brief helper-function to implement is_in, keeps the rows whose key is in the set
+    template<class key_t>
+    auto filter_by_set(const value_set<key_t> &set) const
+    {
+        constexpr std::size_t N = []() {
+            if constexpr( is_tuple_v<key_t> )
+                return std::tuple_size_v<key_t>;
+            else
+                return std::size_t{1};
+        }();
+
+        static_assert( C == -1 || C == static_cast<int>(N), "number of columns must be dynamic or match the number of compared values");
+
+        if( m_col_idx->size() != N )
+            throw std::runtime_error(
+                fmt::format("{}: number of columns must be {}!", __func__, N)
+            );
+
+        MCSV_STATS_PHASE(recorder(), filter);
+        const auto &cols = active_cols();
+
+        std::vector<zone_match> matches;
+
+        // for dense selections, a typed column is tested with a filter kernel
+        if constexpr( !is_tuple_v<key_t> )
+        {
+            matches = set_zone_matches(set, cols.front());
+
+            if( auto decided = decided_by_zones(matches) )
+                return filtered<static_cast<int>(N)>(std::move(*decided));
+
+            if( !m_row_sel->sparse() )
+            {
+                const auto bits = column_kernel<key_t>([&](const key_t &v) { return set.contains(v); }, cols.front(), matches);
+
+                if( bits )
+                    return filtered<static_cast<int>(N)>(*m_row_sel & *bits);
+            }
+        }
+
+        return filtered<static_cast<int>(N)>(m_row_sel->filter([&](std::size_t i) {
+            const auto match = zone_map::row_match(matches, i);
+            return match == zone_match::some ? set.contains(row_key<key_t>(i, cols)) : match == zone_match::all;
+        }));
+    }
+
+    /// @brief helper-function, which appends the active rows of a column to a std::vector
+    template<class T>
+    void push_col_to_vector(std::vector<T> &vec, std::size_t col) const
+    {
+        MCSV_STATS_PHASE(recorder(), extract);
+        MCSV_STATS_ADD(recorder(), conversions, m_row_sel->count());
+
+        vec.reserve(m_row_sel->count());
+
+        m_row_sel->for_each([&](std::size_t i) {
+            vec.push_back(cell<T>(i, col));
+        });
+    }
+
+    /// @brief helper-function, which converts the active rows of a column in parallel
+    /// into a preallocated std::vector
+    template<class T>
+    void fill_col_to_vector(std::vector<T> &vec, std::size_t col, std::size_t threads) const
+    {
+        // std::vector<bool> packs bits, so concurrent writes to it are not possible
+        if constexpr( std::is_same_v<T, bool> )
+        {
+            push_col_to_vector(vec, col);
+        }
+        else
+        {
+            MCSV_STATS_PHASE(recorder(), extract);
+            MCSV_STATS_ADD(recorder(), conversions, m_row_sel->count());
+
+            vec.resize(m_row_sel->count());
+
+            m_row_sel->for_each_parallel(threads, [&](std::size_t i, std::size_t pos) {
+                vec[pos] = cell<T>(i, col);
+            });
+        }
+    }
+
+    /// @brief helper-function, which converts columns in parallel to a tuple of vectors
+    template<class tuple_t, std::size_t... idx>
+    void fill_cols_to_vector_tuple(tuple_t &vector_tuple, const std::vector<std::size_t> &cols,
+                                   std::size_t threads, std::index_sequence<idx...>) const
+    {
+        static_assert( std::tuple_size_v<tuple_t> == sizeof...(idx), "tuple size mismatches index_sequence size");
+
+        (fill_col_to_vector(std::get<idx>(vector_tuple), cols[idx], threads), ...);
+    }
+
+    /// @brief helper-function, which appends the active cells of a row to a csv output buffer.
+    /// Typed columns are formatted from their stored values, the others are written as stored.
+    template<class dialect_t>
+    void append_csv_row(std::string &out, std::size_t row) const
+    {
+        const auto &cols = active_cols();
+
+        for(std::size_t k=0ul; k<cols.size(); ++k)
+        {
+            if( k > 0 )
+                out += dialect_t::delimiter;
+
+            if constexpr( has_dictionary_access_v<loader_t> )
+            {
+                if( const auto *dict = m_loader->dictionary(cols[k]) )
+                {
+                    append_csv_cell<dialect_t>(out, (*dict)[row]);
+                    continue;
+                }
+            }
+
+            if constexpr( has_column_access_v<loader_t> )
+            {
+                m_loader->visit_column(cols[k], [&](const auto *data, std::size_t) {
+                    using stored_t = std::remove_cv_t<std::remove_pointer_t<decltype(data)>>;
+
+                    if constexpr( std::is_same_v<stored_t, std::uint8_t> )
+                        out += data[row] ? "true" : "false";
+                    else if constexpr( std::is_arithmetic_v<stored_t> )
+                        append_csv_number(out, data[row]);
+                    else
+                        append_csv_cell<dialect_t>(out, data[row]);
+                });
+            }
+            else
+            {
+                append_csv_cell<dialect_t>(out, m_loader->data()[row][cols[k]]);
+            }
+        }
+
+        out += '\n';
+    }
+
+    /// @brief helper-function, which converts each active cell to T and passes it to
+    /// store(pos, c, value), where pos is the position of the row among the active rows
+    /// and c the index of the column among the active columns
+    template<class T, class store_fn_t, class... options_t>
+    void export_cells(const store_fn_t &store, const options_t &... options) const
+    {
+        const auto &col_idx = active_cols();
+        const auto threads = make_load_options(options...).threads;
+
+        MCSV_STATS_PHASE(recorder(), extract);
+        MCSV_STATS_ADD(recorder(), conversions, m_row_sel->count() * col_idx.size());
+
+        // column by column, which is cache-friendly for columnar storage
+        for(std::size_t c=0ul; c<col_idx.size(); ++c)
+            m_row_sel->for_each_parallel(threads, [&](std::size_t i, std::size_t pos) {
+                store(pos, c, cell<T>(i, col_idx[c]));
+            });
+    }
+
+    /// @brief helper-function, which converts the active columns into the arrays of a soa
+    template<class soa_t, std::size_t... idx>
+    void fill_soa(soa_t &result, std::size_t threads, std::index_sequence<idx...>) const
+    {
+        const auto &col_idx = active_cols();
+
+        MCSV_STATS_PHASE(recorder(), extract);
+        MCSV_STATS_ADD(recorder(), conversions, m_row_sel->count() * col_idx.size());
+
+        const auto fill_column = [&](auto *data, std::size_t col) {
+            using T = std::remove_pointer_t<decltype(data)>;
+
+            m_row_sel->for_each_parallel(threads, [&](std::size_t i, std::size_t pos) {
+                data[pos] = cell<T>(i, col);
+            });
+        };
+
+        (fill_column(result.template data<idx>(), col_idx[idx]), ...);
+    }
+
+    /// @brief helper-function, which appends columns to a tuple of vectors
+    /// @param vector_tuple std::tuple of std::vectors with different types
+    /// @param cols indices of the columns, one for each vector
+    template<class tuple_t, std::size_t... idx>
+    void push_cols_to_vector_tuple(tuple_t &vector_tuple, const std::vector<std::size_t> &cols,
+                                   std::index_sequence<idx...>) const
+    {
+        static_assert( std::tuple_size_v<tuple_t> == sizeof...(idx), "tuple size mismatches index_sequence size");
+
+        (push_col_to_vector(std::get<idx>(vector_tuple), cols[idx]), ...);
+    }
+
+    /// @brief helper-function to implement the comparison operators.
+    /// @param pred predicate, which is used to compare (std::less, std::equal_to, ...)
+    /// @param tuple each row is compared to the tuple
+    template<class pred_t, class tuple_t>
+    auto row_wise_comparison(const pred_t &pred, const tuple_t &tuple) const
+    {
+        constexpr std::size_t N = std::tuple_size_v<tuple_t>;
+        throw_if_not_comparable<N>();
+
+        MCSV_STATS_PHASE(recorder(), filter);
+        const auto &cols = active_cols();
+
+        // blocks, which are decided by the zone map, are not compared
+        const auto matches = tuple_zone_matches(pred, tuple, cols, std::make_index_sequence<N> {});
+
+        if( auto decided = decided_by_zones(matches) )
+            return filtered<static_cast<int>(N)>(std::move(*decided));
+
+        // for dense selections, typed columns are compared with filter kernels
+        if( !m_row_sel->sparse() )
+        {
+            std::array<std::vector<std::uint64_t>, N> results;
+
+            if( tuple_column_kernels(pred, tuple, cols, matches, results, std::make_index_sequence<N> {}) )
+            {
+                auto bits = std::move(results[0]);
+
+                for(std::size_t k=1; k<N; ++k)
+                    for(std::size_t w=0ul; w<bits.size(); ++w)
+                        bits[w] &= results[k][w];
+
+                return filtered<static_cast<int>(N)>(*m_row_sel & bits);
+            }
+        }
+
+        return filtered<static_cast<int>(N)>(m_row_sel->filter([&](std::size_t i) {
+            const auto match = zone_map::row_match(matches, i);
+            return match == zone_match::some ? compare_tuple_and_row(pred, tuple, i, cols, std::make_index_sequence<N> {})
+                                             : match == zone_match::all;
+        }));
+    }
+
+    /// @brief throws, if the number of active columns does not match the tuple size N of a comparison
+    template<std::size_t N>
+    void throw_if_not_comparable() const
+    {
+        static_assert( C == -1 || C == static_cast<int>(N), "row-wise comparison only possible if tuple size matches column number" );
+
+        if( m_col_idx->size() != N )
+            throw std::runtime_error(
+                fmt::format("{}: row-wise comparison only possible if tuple size matches column number",__func__)
+            );
+    }
+
+    /// @brief helper-function to implement the comparisons of column_expr. The dataframe is
+    /// copied into the predicate (only shared pointers), so the expression stays valid on its own.
+    template<class pred_t, class tuple_t>
+    auto lazy_comparison(const pred_t &pred, const tuple_t &tuple) const
+    {
+        constexpr std::size_t N = std::tuple_size_v<tuple_t>;
+        throw_if_not_comparable<N>();
+
+        auto row_pred = [df = *this, pred, tuple](std::size_t i) {
+            return df.compare_tuple_and_row(pred, tuple, i, df.active_cols(), std::make_index_sequence<N> {});
+        };
+
+        return filter_expr<loader_t, decltype(row_pred)>(m_loader, m_row_sel, std::move(row_pred));
+    }
+
+    /// @brief helper-function to implement column_expr::is_in
+    template<class iterable_t>
+    auto lazy_is_in(const iterable_t &iterable) const
+    {
+        using key_t = std::decay_t<decltype(*std::begin(iterable))>;
+        constexpr std::size_t N = []() {
+            if constexpr( is_tuple_v<key_t> )
+                return std::tuple_size_v<key_t>;
+            else
+                return std::size_t{1};
+        }();
+        throw_if_not_comparable<N>();
+
+        auto set = std::make_shared<value_set<key_t>>();
+
+        for(const auto &value : iterable)
+            set->insert(value);
+
+        auto row_pred = [df = *this, set](std::size_t i) {
+            return set->contains(df.template row_key<key_t>(i, df.active_cols()));
+        };
+
+        return filter_expr<loader_t, decltype(row_pred)>(m_loader, m_row_sel, std::move(row_pred));
+    }
+
+    /// @brief aggregates of the groups of a part of the rows. Group g has the
+    /// states[g * aggs ... (g + 1) * aggs - 1] for its aggregations.
+    template<class key_t>
+    struct group_partial
+    {
+        std::vector<key_t> keys;
+        std::vector<aggregate_state> states;
+    };
+
+    /// @brief estimates on the first rows, if the key column has so many distinct values,
+    /// that sorting is faster than hashing
+    template<class key_t>
+    bool high_cardinality(std::size_t key_col) const
+    {
+        constexpr std::size_t sample_size = 1ul << 16;
+
+        std::unordered_set<key_t> sample;
+        std::size_t n = 0;
+
+        for(auto it = m_row_sel->begin(); it != m_row_sel->end() && n < sample_size; ++it, ++n)
+            sample.insert(cell<key_t>(*it, key_col));
+
+        return n == sample_size && sample.size() > n / 2;
+    }
+
+    /// @brief implements groupby(key).agg(aggs). Each part of the rows is aggregated by an own
+    /// thread into a partial result, either with an open-addressing hash index or (for keys with
+    /// high cardinality) by sorting the rows by key. The partial results are merged at the end.
+    template<class key_t>
+    auto aggregate(const std::string &key, const std::vector<aggregation> &aggs, std::size_t threads) const
+    {
+        const auto key_col = column_index(key);
+        const auto n_aggs = aggs.size();
+
+        std::vector<std::size_t> value_cols(n_aggs, 0);
+        for(std::size_t a=0ul; a<n_aggs; ++a)
+            if( aggs[a].kind != aggregation::kind_t::count )
+                value_cols[a] = column_index(aggs[a].column);
+
+        // adds the values of a row to the states of a group
+        const auto add_row = [&](aggregate_state *states, std::size_t row) {
+            for(std::size_t a=0ul; a<n_aggs; ++a)
+            {
+                if( aggs[a].kind == aggregation::kind_t::count )
+                    ++states[a].count;
+                else
+                    states[a].add(cell<double>(row, value_cols[a]));
+            }
+        };
+
+        const auto parts = m_row_sel->parts(threads);
+        std::vector<group_partial<key_t>> partials(parts);
+
+        if( !high_cardinality<key_t>(key_col) )
+        {
+            std::vector<group_index<key_t>> indices(parts);
+
+            m_row_sel->for_each_part(parts, [&](std::size_t p, std::size_t row, std::size_t) {
+                auto &partial = partials[p];
+                const auto g = indices[p].find_or_insert(cell<key_t>(row, key_col), partial.keys);
+
+                if( partial.states.size() == g * n_aggs )
+                    partial.states.resize((g + 1) * n_aggs);
+
+                add_row(partial.states.data() + g * n_aggs, row);
+            });
+        }
+        else
+        {
+            std::vector<std::vector<std::pair<key_t, std::size_t>>> keyed_rows(parts);
+
+            m_row_sel->for_each_part(parts, [&](std::size_t p, std::size_t row, std::size_t) {
+                keyed_rows[p].emplace_back(cell<key_t>(row, key_col), row);
+            });
+
+            run_parallel(parts, [&](std::size_t p) {
+                auto &rows = keyed_rows[p];
+                auto &partial = partials[p];
+
+                std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+                for(std::size_t i=0ul; i<rows.size(); ++i)
+                {
+                    if( i == 0 || !(rows[i].first == rows[i-1].first) )
+                    {
+                        partial.keys.push_back(rows[i].first);
+                        partial.states.resize(partial.keys.size() * n_aggs);
+                    }
+
+                    add_row(partial.states.data() + (partial.keys.size() - 1) * n_aggs, rows[i].second);
+                }
+            });
+        }
+
+        // merge the groups of all partial results in the order of the keys
+        std::vector<std::pair<std::size_t, std::size_t>> groups;
+        for(std::size_t p=0ul; p<parts; ++p)
+            for(std::size_t g=0ul; g<partials[p].keys.size(); ++g)
+                groups.emplace_back(p, g);
+
+        std::sort(groups.begin(), groups.end(), [&](const auto &a, const auto &b) {
+            return partials[a.first].keys[a.second] < partials[b.first].keys[b.second];
+        });
+
+        std::vector<std::string> header = {key};
+        for(const auto &agg : aggs)
+            header.push_back(agg.name());
+
+        cell_arena cells;
+        std::vector<aggregate_state> merged(n_aggs);
+
+        for(std::size_t i=0ul; i<groups.size(); )
+        {
+            const auto &group_key = partials[groups[i].first].keys[groups[i].second];
+            std::fill(merged.begin(), merged.end(), aggregate_state{});
+
+            for(; i<groups.size() && partials[groups[i].first].keys[groups[i].second] == group_key; ++i)
+                for(std::size_t a=0ul; a<n_aggs; ++a)
+                    merged[a].merge(partials[groups[i].first].states[groups[i].second * n_aggs + a]);
+
+            if constexpr( std::is_convertible_v<key_t, std::string_view> )
+                cells.push(group_key);
+            else
+                cells.push(fmt::format("{}", group_key));
+
+            for(std::size_t a=0ul; a<n_aggs; ++a)
+                cells.push(fmt::format("{}", merged[a].result(aggs[a].kind)));
+        }
+
+        return dataframe<default_loader>(std::make_shared<default_loader>(std::move(header), std::move(cells)));
+    }
+
+    /// @brief helper-function, which extracts a column as a std::vector of strings
+    auto col_as_str_vector(std::size_t idx)
+    {
+        if( !std::binary_search(m_col_idx->begin(), m_col_idx->end(), idx) )
+            throw std::runtime_error(std::string(__func__) + "col_as_vector: requested invalid column");
+
+        std::vector<std::string> col;
+        col.reserve(m_row_sel->count());
+
+        for(const auto &row : row_iterable())
+            col.emplace_back(row[idx]);
+
+        return col;
+    }
+
+    /// @brief helper-function, which converts a row (std::vector or row_view) to a std::array
+    template<std::size_t N, class row_t>
+    auto row_as_str_array(const row_t &row) const
+    {
+        std::array<std::string, N> array;
+        auto array_it = array.begin();
+
+        for(const auto &cell : col_iterable(row) )
+        {
+            *array_it = cell;
+            ++array_it;
+        }
+
+        return array;
+    }
+
+    /// @brief helper-function, which "extracts" a row as a std::vector of strings
+    auto row_as_str_vector(std::size_t idx)
+    {
+        if( !m_row_sel->test(idx) )
+            throw std::runtime_error(std::string(__func__) + "row_as_vector: requested invalid column");
+
+        return m_loader->data()[idx];
+    }
+
+public:
+    /// @brief returns the header of the csv-file
+    const auto &header() const
+    {
+        return m_loader->header();
+    }
+
+    /// @brief returns the statistics of the loading and of all queries on the loader, which
+    /// is shared by all dataframes derived from the same file. Only recorded with MCSV_ENABLE_STATS.
+    mcsv::stats stats() const
+    {
+        if( const auto *r = recorder() )
+            return r->snapshot();
+
+        return {};
+    }
+
+    /// @brief builds the zone map of the loader: the minimum, maximum and number of empty
+    /// cells of all columns in blocks of zone_map::block_rows rows. It is shared by all dataframes
+    /// over the same loader, the comparisons and is_in then skip the blocks, whose result is known.
+    /// Accepts mcsv::parallel to compute the blocks in parallel.
+    template<class... options_t>
+    void build_index(const options_t &... options) const
+    {
+        const auto threads = make_load_options(options...).threads;
+
+        m_zones->set(std::make_shared<const zone_map>(m_loader->data().size(), m_loader->header().size(), threads,
+                                                      [&](std::size_t col, std::size_t begin, std::size_t end) {
+            return block_stats(col, begin, end);
+        }));
+    }
+
+    /// @brief returns the zone map built by build_index, or nullptr
+    std::shared_ptr<const zone_map> index() const
+    {
+        return m_zones->get();
+    }
+
+    /// @brief returns the number of active rows (cached, O(1))
+    auto rows() const
+    {
+        return static_cast<std::ptrdiff_t>(m_row_sel->count());
+    }
+
+    /// @brief returns the number of active columns
+    auto cols() const
+    {
+        return static_cast<std::ptrdiff_t>(m_col_idx->size());
+    }
+
+    /// @brief returns the selection of active rows
+    const auto &selected_rows() const
+    {
+        return *m_row_sel;
+    }
+
+    /// @brief returns a row-iterable, which can be used in a range-based for-loop
+    auto row_iterable() const
+    {
+        return indexed_iterable(m_loader->data(), m_row_sel);
+    }
+
+    /// @brief returns a column-iterable, which can be used in a range-based for-loop
+    template<class row_t>
+    auto col_iterable(const row_t &row) const
+    {
+        return indexed_iterable(row, m_col_idx);
     }
 
     /// @brief compares (==) a dataframe with a tuple.
@@ -431,297 +5689,1758 @@ public:
     template<class tuple_t>
     auto operator==(const tuple_t &tuple) const
     {
-        return row_wise_comparison(std::equal_to{}, tuple);
+        return row_wise_comparison(std::equal_to{}, tuple);
+    }
+
+    /// @brief compares (!=) a dataframe with a tuple.
+    /// @return a dataframe, which contains only the rows which do not match completely
+    template<class tuple_t>
+    auto operator!=(const tuple_t &tuple) const
+    {
+        const auto equal = ( *this == tuple );
+        return decltype(equal)(m_loader, m_row_sel->without(*equal.m_row_sel), m_col_idx, m_zones);
+    }
+
+    /// @brief compares (<) a dataframe with a tuple.
+    /// @return a dataframe, which contains only matching rows
+    template<class tuple_t>
+    auto operator<(const tuple_t &tuple) const
+    {
+        return row_wise_comparison(std::less{}, tuple);
+    }
+
+    /// @brief compares (<=) a dataframe with a tuple.
+    /// @return a dataframe, which contains only matching rows
+    template<class tuple_t>
+    auto operator<=(const tuple_t &tuple) const
+    {
+        return row_wise_comparison(std::less_equal{}, tuple);
+    }
+
+    /// @brief compares (>) a dataframe with a tuple.
+    /// @return a dataframe, which contains only matching rows
+    template<class tuple_t>
+    auto operator>(const tuple_t &tuple) const
+    {
+        return row_wise_comparison(std::greater{}, tuple);
+    }
+
+    /// @brief compares (>=) a dataframe with a tuple.
+    /// @return a dataframe, which contains only matching rows
+    template<class tuple_t>
+    auto operator>=(const tuple_t &tuple) const
+    {
+        return row_wise_comparison(std::greater_equal{}, tuple);
+    }
+    
+    /// @brief filters rows with respect to an iterable. The set of values is built once per
+    /// call (hash set, or sorted vector for small sets). For one active column the iterable
+    /// contains values, for N active columns it contains std::tuples with N elements.
+    template<typename iterable_t,
+             typename = decltype(std::begin(std::declval<iterable_t>())),
+             typename = decltype(std::end(std::declval<iterable_t>()))>
+    auto is_in(const iterable_t &iterable) const
+    {
+        using key_t = std::decay_t<decltype(*std::begin(iterable))>;
+
+        value_set<key_t> set;
+
+        for(const auto &value : iterable)
+            set.insert(value);
+
+        return filter_by_set(set);
+    }
+
+    /// @brief filters rows with respect to the active rows of another dataframe. The set is
+    /// built directly from the cells of the other dataframe, without intermediate vector.
+    /// Both dataframes need to have sizeof...(Ts) active columns.
+    /// @tparam Ts types, in which the cells of both dataframes are converted for comparison
+    template<typename... Ts, class other_loader_t, int OC>
+    auto is_in(const dataframe<other_loader_t, OC> &other) const
+    {
+        static_assert( sizeof...(Ts) > 0, "is_in needs the types of the compared columns, e.g. is_in<int>(df)" );
+        static_assert( OC == -1 || OC == static_cast<int>(sizeof...(Ts)), "number of columns of the other dataframe must match the number of types" );
+
+        using key_t = std::conditional_t<sizeof...(Ts) == 1, std::tuple_element_t<0, std::tuple<Ts...>>, std::tuple<Ts...>>;
+
+        if( other.cols() != static_cast<std::ptrdiff_t>(sizeof...(Ts)) )
+            throw std::runtime_error(
+                fmt::format("{}: number of columns of the other dataframe must be {}!", __func__, sizeof...(Ts))
+            );
+
+        value_set<key_t> set;
+        set.reserve(other.m_row_sel->count());
+
+        const auto &other_cols = other.active_cols();
+
+        other.m_row_sel->for_each([&](std::size_t i) {
+            set.insert(other.template row_key<key_t>(i, other_cols));
+        });
+
+        return filter_by_set(set);
+    }
+
+    /// @brief logical AND operator, only affects the row mask
+    template<int OC>
+    auto operator&&(const dataframe<loader_t, OC> &df) const
+    {
+        static_assert( C == -1 || C == OC, "number of columns does not match");
+
+        if( df.m_loader != m_loader )
+            throw std::runtime_error(
+                fmt::format("{}: cannot logically combine dataframes of differen csv-files", __func__)
+            );
+
+        return dataframe<loader_t, C>(m_loader, *m_row_sel & *df.m_row_sel, m_col_idx, m_zones);
+    }
+
+    /// @brief logical OR operator, only affects the row mask
+    template<int OC>
+    auto operator||(const dataframe<loader_t, OC> &df) const
+    {
+        static_assert( C == -1 || C == OC, "number of columns does not match");
+
+        if( df.m_loader != m_loader )
+            throw std::runtime_error(
+                fmt::format("{}cannot logically combine dataframes of differen csv-files", __func__)
+            );
+
+        return dataframe<loader_t, C>(m_loader, *m_row_sel | *df.m_row_sel, m_col_idx, m_zones);
+    }
+
+    /// @brief filters the dataframe with respect to column names
+    /// @param args parameter-pack, which only is allowed to be of string-like types
+    template< class... Ts, typename = std::enable_if_t<std::conjunction_v< std::is_convertible<Ts,std::string>... >> >
+    auto operator()(Ts... args) const
+    {
+        std::tuple<Ts...> arg_tuple(args...);
+        constexpr std::size_t N = std::tuple_size_v<decltype(arg_tuple)>;
+
+        auto cols = string_tuple_to_array(arg_tuple, std::make_index_sequence<N> {});
+
+        std::vector<bool> new_col_mask(m_loader->header().size(), false);
+        for(const auto &col : cols)
+        {
+            new_col_mask[ m_loader->header_map().at(col) ] = true;
+        }
+
+        auto new_col_idx = std::make_shared<std::vector<std::size_t>>();
+        for(std::size_t i=0ul; i<new_col_mask.size(); ++i)
+            if( new_col_mask[i] )
+                new_col_idx->push_back(i);
+
+        return dataframe<loader_t, static_cast<int>(N)>(m_loader, m_row_sel, std::move(new_col_idx), m_zones);
+    }
+
+    /// @brief filter the rows of a dataframe with help of another dataframe
+    /// @param df input-dataframe, from which the rows are used
+    /// @return dataframe, which has the rows of the input dataframe, but the original columns
+    template<int OC>
+    auto select_rows(const dataframe<loader_t, OC> &df) const
+    {
+        if( df.m_loader != m_loader )
+            throw std::runtime_error(
+                fmt::format("{}: cannot select rows based on a different csv-file.", __func__)
+            );
+
+        return dataframe<loader_t, C>(m_loader, df.m_row_sel, m_col_idx, m_zones);
+    }
+
+    /// @brief groups the active rows by the values of a column, e.g.
+    /// df.groupby("host").agg(mcsv::count(), mcsv::mean("latency"))
+    /// @tparam key_t type, in which the key column is converted
+    /// @param options option tags, e.g. mcsv::parallel{8} to aggregate in parallel
+    template<class key_t = std::string, class... options_t>
+    auto groupby(std::string key, const options_t &... options) const
+    {
+        return grouped_dataframe<loader_t, C, key_t>(*this, std::move(key), make_load_options(options...).threads);
+    }
+
+    /// @brief orders the active rows by the values of a column. Only a permutation of the rows
+    /// is stored, the data is still shared with the original dataframe. Equal values keep their
+    /// previous order, so sorting by several columns is done with the least significant first.
+    /// @tparam T type, in which the column is converted. Arithmetic types are radix sorted,
+    /// all other types are compared with operator<.
+    /// @param col name of the column
+    /// @param ascending sort in ascending or descending order
+    template<class T = double>
+    auto sort_by(const std::string &col, bool ascending = true) const
+    {
+        using value_t = std::remove_cv_t<std::remove_reference_t<T>>;
+
+        const auto c = column_index(col);
+        const auto n = m_row_sel->count();
+
+        std::vector<std::size_t> rows;
+        rows.reserve(n);
+        m_row_sel->for_each([&](std::size_t row) { rows.push_back(row); });
+
+        if constexpr( std::is_arithmetic_v<value_t> )
+        {
+            std::vector<std::uint64_t> keys(n);
+            for(std::size_t i=0ul; i<n; ++i)
+            {
+                const auto key = radix_key(cell<value_t>(rows[i], c));
+                keys[i] = ascending ? key : ~key;
+            }
+
+            radix_sort(keys, rows);
+        }
+        else
+        {
+            std::vector<value_t> keys(n);
+            for(std::size_t i=0ul; i<n; ++i)
+                keys[i] = cell<value_t>(rows[i], c);
+
+            std::vector<std::size_t> perm(n);
+            std::iota(perm.begin(), perm.end(), std::size_t{0});
+
+            if( ascending )
+                std::stable_sort(perm.begin(), perm.end(), [&](auto a, auto b) { return keys[a] < keys[b]; });
+            else
+                std::stable_sort(perm.begin(), perm.end(), [&](auto a, auto b) { return keys[b] < keys[a]; });
+
+            for(auto &p : perm)
+                p = rows[p];
+
+            rows = std::move(perm);
+        }
+
+        return dataframe<loader_t, C>(m_loader, m_row_sel->with_order(std::move(rows)), m_col_idx, m_zones);
+    }
+
+    /// @brief selects the k active rows with the largest values in a column, ordered from the
+    /// largest value downwards. Each part of the rows keeps its best k rows in a heap, so only
+    /// rows better than the current k-th row cost more than one comparison.
+    /// @tparam T type, in which the column is converted
+    /// @param col name of the column
+    /// @param k maximum number of rows
+    /// @param options option tags, e.g. mcsv::parallel{8} to select the rows in parallel
+    template<class T = double, class... options_t>
+    auto top_k(const std::string &col, std::size_t k, const options_t &... options) const
+    {
+        using value_t = std::remove_cv_t<std::remove_reference_t<T>>;
+
+        struct entry
+        {
+            value_t value;
+            std::size_t pos;
+            std::size_t row;
+        };
+
+        // larger values first, equal values in visiting order
+        const auto better = [](const entry &a, const entry &b) {
+            return b.value < a.value || ( !(a.value < b.value) && a.pos < b.pos );
+        };
+
+        const auto c = column_index(col);
+        const auto parts = m_row_sel->parts(make_load_options(options...).threads);
+
+        // the heaps are ordered by better, so the front is the worst row kept
+        std::vector<std::vector<entry>> heaps(parts);
+        for(auto &heap : heaps)
+            heap.reserve(std::min(k, m_row_sel->count()));
+
+        if( k > 0 )
+        {
+            m_row_sel->for_each_part(parts, [&](std::size_t part, std::size_t row, std::size_t pos) {
+                auto &heap = heaps[part];
+                entry e{ cell<value_t>(row, c), pos, row };
+
+                if( heap.size() < k )
+                {
+                    heap.push_back(std::move(e));
+                    std::push_heap(heap.begin(), heap.end(), better);
+                }
+                else if( better(e, heap.front()) )
+                {
+                    std::pop_heap(heap.begin(), heap.end(), better);
+                    heap.back() = std::move(e);
+                    std::push_heap(heap.begin(), heap.end(), better);
+                }
+            });
+        }
+
+        auto &best = heaps.front();
+        for(std::size_t p=1ul; p<parts; ++p)
+            std::move(heaps[p].begin(), heaps[p].end(), std::back_inserter(best));
+
+        const auto n = std::min(k, best.size());
+        std::partial_sort(best.begin(), best.begin() + static_cast<std::ptrdiff_t>(n), best.end(), better);
+
+        std::vector<std::size_t> rows(n);
+        for(std::size_t i=0ul; i<n; ++i)
+            rows[i] = best[i].row;
+
+        auto sorted_rows = rows;
+        std::sort(sorted_rows.begin(), sorted_rows.end());
+
+        auto new_row_sel = row_selection::from_indices(m_row_sel->size(), std::move(sorted_rows)).with_order(std::move(rows));
+        return dataframe<loader_t, C>(m_loader, std::move(new_row_sel), m_col_idx, m_zones);
+    }
+
+    /// @brief returns the active columns for building a deferred filter, e.g.
+    /// df.select_rows( df("a").lazy() < std::tuple(1) || df("b").lazy() > std::tuple(2) )
+    auto lazy() const
+    {
+        return column_expr<loader_t, C>(*this);
+    }
+
+    /// @brief filter the rows of a dataframe with a deferred filter expression. The expression
+    /// is evaluated here, in one pass over its rows.
+    /// @return dataframe, which has the rows matching the expression, but the original columns
+    template<class pred_t>
+    auto select_rows(const filter_expr<loader_t, pred_t> &expr) const
+    {
+        if( expr.loader() != m_loader )
+            throw std::runtime_error(
+                fmt::format("{}: cannot select rows based on a different csv-file.", __func__)
+            );
+
+        MCSV_STATS_PHASE(recorder(), filter);
+        return dataframe<loader_t, C>(m_loader, expr.evaluate(), m_col_idx, m_zones);
+    }
+
+    /// @brief filter the columns of a dataframe with help of another dataframe
+    /// @param df input-dataframe, from which the collumns are used
+    /// @return dataframe, which has the columns of the input dataframe, but the original rows
+    template<int OC>
+    auto select_cols(const dataframe<loader_t, OC> &df) const
+    {
+        if( df.m_loader != m_loader )
+            throw std::runtime_error(
+                fmt::format("{}: cannot select rows based on a different csv-file.", __func__)
+            );
+
+        return dataframe<loader_t, C>(m_loader, m_row_sel, df.m_col_idx, m_zones);
+    }
+
+    /// @brief writes the active columns and rows (in visiting order) as csv-file with header.
+    /// The rows are formatted in batches into large buffers, which are written with one call
+    /// each. In parallel mode, each thread formats a part of a batch into an own buffer.
+    /// The dataframe does not know the dialect of its input, the output is written in the
+    /// dialect given as option tag (comma-separated and quoted with " by default).
+    /// @param options option tags, e.g. mcsv::parallel{8} to format the rows in parallel
+    /// or mcsv::dialect<';'>{} to separate the cells by semicolons
+    template<class... options_t>
+    void to_csv(const std::filesystem::path &path, const options_t &... options) const
+    {
+        using dialect_t = dialect_of_t<options_t...>;
+
+        std::ofstream file(path, std::ios::binary);
+
+        if( !file )
+            throw std::runtime_error(fmt::format("{}: could not open '{}'", __func__, path.string()));
+
+        const auto threads = std::max(make_load_options(options...).threads, std::size_t{1});
+        std::vector<std::string> buffers(threads);
+
+        if constexpr( dialect_t::header )
+        {
+            const auto &cols = active_cols();
+
+            for(std::size_t k=0ul; k<cols.size(); ++k)
+            {
+                if( k > 0 )
+                    buffers[0] += dialect_t::delimiter;
+
+                append_csv_cell<dialect_t>(buffers[0], header()[cols[k]]);
+            }
+            buffers[0] += '\n';
+        }
+
+        std::vector<std::size_t> batch;
+        batch.reserve(threads * row_selection::min_parallel_rows);
+
+        const auto write_batch = [&]() {
+            const auto parts = std::clamp(batch.size() / row_selection::min_parallel_rows, std::size_t{1}, threads);
+            const auto format = [&](std::size_t p) {
+                for(auto i = batch.size() * p / parts; i < batch.size() * (p + 1) / parts; ++i)
+                    append_csv_row<dialect_t>(buffers[p], batch[i]);
+            };
+
+            if( parts == 1 )
+                format(0);
+            else
+                run_parallel(parts, format);
+
+            for(std::size_t p=0ul; p<parts; ++p)
+            {
+                file.write(buffers[p].data(), static_cast<std::streamsize>(buffers[p].size()));
+                buffers[p].clear();
+            }
+
+            batch.clear();
+        };
+
+        m_row_sel->for_each([&](std::size_t row) {
+            batch.push_back(row);
+
+            if( batch.size() == batch.capacity() )
+                write_batch();
+        });
+        write_batch();
+
+        if( !file.flush() )
+            throw std::runtime_error(fmt::format("{}: could not write '{}'", __func__, path.string()));
+    }
+
+    /// @brief extracts one ore more columns as std::vectors
+    /// @tparam Ts the types in which the columns can be converted. For a schema_loader, Ts can be
+    /// omitted, then const references to its typed columns are returned without copying. This
+    /// requires all rows and columns in their original order.
+    /// @param options option tags, e.g. mcsv::parallel{8} to convert the rows in parallel
+    /// @return a std::vector, if Ts is just one type, otherwise a std::tuple of std::vectors
+    template<typename... Ts, class... options_t>
+    decltype(auto) cols_to_vectors(const options_t &... options) const &
+    {
+        if constexpr( sizeof...(Ts) == 0 && is_schema_loader_v<loader_t> )
+            return column_refs();
+        else
+            return convert_cols_to_vectors<Ts...>(options...);
+    }
+
+    /// @brief like cols_to_vectors on an lvalue, but the typed columns of a schema_loader are copied,
+    /// since the loader may be destroyed together with this dataframe
+    template<typename... Ts, class... options_t>
+    auto cols_to_vectors(const options_t &... options) &&
+    {
+        if constexpr( sizeof...(Ts) == 0 && is_schema_loader_v<loader_t> )
+            return column_copies();
+        else
+            return convert_cols_to_vectors<Ts...>(options...);
+    }
+
+private:
+    /// @brief references to the typed columns of a schema_loader, see cols_to_vectors
+    decltype(auto) column_refs() const
+    {
+        if( m_row_sel->count() != m_row_sel->size() || m_row_sel->ordered() ||
+            active_cols() != all_cols(m_loader->header().size()) )
+            throw std::runtime_error(
+                fmt::format("{}: references to the columns require all rows and columns in their original order, "
+                            "use cols_to_vectors<Ts...>() for a selection", __func__));
+
+        auto refs = std::apply([](const auto &... column) { return std::tie(column...); }, m_loader->columns());
+
+        if constexpr( std::tuple_size_v<decltype(refs)> == 1ul )
+            return std::get<0>(refs);
+        else
+            return refs;
+    }
+
+    auto column_copies() const
+    {
+        decltype(auto) refs = column_refs();
+
+        if constexpr( std::is_reference_v<decltype(refs)> )
+            return std::decay_t<decltype(refs)>(refs);
+        else
+            return std::apply([](const auto &... column) { return std::make_tuple(column...); }, refs);
+    }
+
+    template<typename... Ts, class... options_t>
+    auto convert_cols_to_vectors(const options_t &... options) const
+    {
+        constexpr std::size_t N = std::tuple_size_v<std::tuple<Ts...>>;
+
+        static_assert( C == -1 || C == static_cast<int>(N), "number of template parameters does not match number of cols");
+
+        if( N != cols() )
+            throw std::runtime_error(
+                fmt::format("{}: number of template parameters does not match number of cols", __func__)
+            );
+
+        std::tuple< std::vector<Ts>... > result_tuple;
+        const auto &col_idx = active_cols();
+        const auto threads = make_load_options(options...).threads;
+
+        // column by column, which is cache-friendly for columnar storage
+        if( threads > 1 )
+            fill_cols_to_vector_tuple(result_tuple, col_idx, threads, std::make_index_sequence<N> {});
+        else
+            push_cols_to_vector_tuple(result_tuple, col_idx, std::make_index_sequence<N> {});
+
+        if constexpr( N == 1ul )
+            return std::get<0>(result_tuple);
+        else
+            return result_tuple;
+    }
+
+public:
+    /// @brief extracts all rows as std::vectors of a specific type
+    /// @tparam T the type in which the rows are converted
+    /// @param options option tags, e.g. mcsv::parallel{8} to convert the rows in parallel
+    /// @return a std::vector of std::vector of T
+    template<typename T, class... options_t>
+    auto rows_to_vectors(const options_t &... options)
+    {
+        std::vector<std::vector<T>> vecs(m_row_sel->count());
+
+        const auto &col_idx = active_cols();
+
+        m_row_sel->for_each_parallel(make_load_options(options...).threads, [&](std::size_t i, std::size_t pos) {
+            auto &vec = vecs[pos];
+            vec.reserve(col_idx.size());
+
+            for(auto col : col_idx)
+                vec.push_back( cell<T>(i, col) );
+        });
+
+        return vecs;
+    }
+
+    /// @brief converts the active cells directly into a caller-provided buffer of rows() * cols()
+    /// elements, e.g. to reuse the buffer for several batches
+    /// @param data pointer to the buffer
+    /// @param order whether the cells of a row (row_major) or of a column (col_major) are contiguous
+    /// @param options option tags, e.g. mcsv::parallel{8} to convert the rows in parallel
+    template<typename T, class... options_t>
+    void export_into(T *data, storage_order order, const options_t &... options) const
+    {
+        const auto n_rows = m_row_sel->count();
+        const auto n_cols = m_col_idx->size();
+
+        if( order == storage_order::row_major )
+            export_cells<T>([&](std::size_t r, std::size_t c, T value) { data[r * n_cols + c] = std::move(value); }, options...);
+        else
+            export_cells<T>([&](std::size_t r, std::size_t c, T value) { data[c * n_rows + r] = std::move(value); }, options...);
+    }
+
+#ifdef __cpp_lib_span
+    /// @brief converts the active cells directly into a caller-provided std::span,
+    /// which must have exactly rows() * cols() elements
+    template<typename T, std::size_t E, class... options_t>
+    void export_into(std::span<T, E> span, storage_order order, const options_t &... options) const
+    {
+        if( span.size() != m_row_sel->count() * m_col_idx->size() )
+            throw std::runtime_error(
+                fmt::format("{}: span has {} elements, but the dataframe has {} cells",
+                            __func__, span.size(), m_row_sel->count() * m_col_idx->size()));
+
+        export_into(span.data(), order, options...);
+    }
+#endif
+
+    /// @brief extracts all rows as std::tuples. Tuple element k is converted from the k-th
+    /// active column to the k-th type, each cell is converted exactly once.
+    /// @tparam Ts the types in which the columns are converted
+    /// @param options option tags, e.g. mcsv::parallel{8} to convert the rows in parallel
+    /// @return a std::vector of std::tuple<Ts...>
+    template<typename... Ts, class... options_t>
+    auto rows_to_tuples(const options_t &... options) const
+    {
+        constexpr std::size_t N = sizeof...(Ts);
+
+        static_assert( C == -1 || C == static_cast<int>(N), "number of template parameters does not match number of cols");
+
+        if( N != cols() )
+            throw std::runtime_error(
+                fmt::format("{}: number of template parameters does not match number of cols", __func__)
+            );
+
+        std::vector<std::tuple<Ts...>> tuples(m_row_sel->count());
+        const auto &col_idx = active_cols();
+
+        m_row_sel->for_each_parallel(make_load_options(options...).threads, [&](std::size_t i, std::size_t pos) {
+            tuples[pos] = row_key<std::tuple<Ts...>>(i, col_idx);
+        });
+
+        return tuples;
+    }
+
+    /// @brief extracts one ore more columns as struct of arrays (mcsv::soa), i.e. one
+    /// contiguous array for each column
+    /// @tparam Ts the types in which the columns are converted
+    /// @param options option tags, e.g. mcsv::parallel{8} to convert the rows in parallel
+    template<typename... Ts, class... options_t>
+    auto cols_to_soa(const options_t &... options) const
+    {
+        constexpr std::size_t N = sizeof...(Ts);
+
+        static_assert( C == -1 || C == static_cast<int>(N), "number of template parameters does not match number of cols");
+
+        if( N != cols() )
+            throw std::runtime_error(
+                fmt::format("{}: number of template parameters does not match number of cols", __func__)
+            );
+
+        soa<Ts...> result(m_row_sel->count());
+        fill_soa(result, make_load_options(options...).threads, std::make_index_sequence<N> {});
+
+        return result;
+    }
+
+#ifdef MCSV_EIGEN_SUPPORT
+
+    /// @brief converts a csv-file in an Eigen::Array.
+    /// @tparam T the type of the Eigen::Array.
+    /// @tparam OR the rows of the Eigen::Array (-1 for Eigen::Dynamic)
+    /// @tparam OC the columns of the Eigen::Array (-1 for Eigen::Dynamic)
+    /// @param options option tags, e.g. mcsv::parallel{8} to convert the rows in parallel
+    /// @return A fixed- or dynamic sized Eigen::Array
+    template<typename T, int OR = -1, int OC = -1, class... options_t>
+    auto to_eigen_array(const options_t &... options) const
+    {
+        static_assert( OC == -1 || C == -1 || OC == C, "column number mismatch for fixed size eigen export");
+
+        if( OR != -1 && rows() != OR )
+            throw std::runtime_error(
+                fmt::format("{}: row number mismatch for fixed size eigen export", __func__)
+            );
+
+        if( OC != -1 && cols() != OC )
+            throw std::runtime_error(
+                fmt::format("{}: column number mismatch for fixed size eigen export", __func__)
+            );
+
+        Eigen::Array<T, OR, OC> array;
+        array.resize(rows(),cols());
+
+        export_into(array, options...);
+
+        return array;
+    }
+
+    /// @brief converts the active cells directly into a caller-provided Eigen object with
+    /// rows() rows and cols() columns, e.g. an Eigen::Ref, a block or a Map of an existing buffer
+    /// @param options option tags, e.g. mcsv::parallel{8} to convert the rows in parallel
+    template<typename eigen_t, class... options_t,
+             typename = std::enable_if_t<std::is_base_of_v<Eigen::DenseBase<std::decay_t<eigen_t>>, std::decay_t<eigen_t>>>>
+    void export_into(eigen_t &&out, const options_t &... options) const
+    {
+        using T = typename std::decay_t<eigen_t>::Scalar;
+
+        if( out.rows() != rows() || out.cols() != cols() )
+            throw std::runtime_error(
+                fmt::format("{}: target has size {}x{}, but the dataframe has size {}x{}",
+                            __func__, out.rows(), out.cols(), rows(), cols()));
+
+        export_cells<T>([&](std::size_t r, std::size_t c, T value) {
+            out(static_cast<Eigen::Index>(r), static_cast<Eigen::Index>(c)) = value;
+        }, options...);
+    }
+
+    /// @brief converts a csv-file in an Eigen::Matrix.
+    /// @tparam T the type of the Eigen::Matrix.
+    /// @tparam OR the rows of the Eigen::Matrix (-1 for Eigen::Dynamic)
+    /// @tparam OC the columns of the Eigen::Matrix (-1 for Eigen::Dynamic)
+    /// @param options option tags, e.g. mcsv::parallel{8} to convert the rows in parallel
+    /// @return A fixed- or dynamic sized Eigen::Matrix
+    template<typename T, int OR = -1, int OC = -1, class... options_t>
+    auto to_eigen_matrix(const options_t &... options) const
+    {
+        return to_eigen_array<T,OR,OC>(options...).matrix();
+    }
+
+#endif // CSV_EIGEN_SUPPORT
+};
+
+using default_dataframe = dataframe<default_loader>;
+using mmap_dataframe = dataframe<mmap_loader>;
+using columnar_dataframe = dataframe<columnar_loader>;
+
+template<class... Ts>
+using schema_dataframe = dataframe<schema_loader<Ts...>, static_cast<int>(sizeof...(Ts))>;
+
+/// @brief dataframe type of a schema
+template<class T>
+struct schema_dataframe_type;
+
+template<class... Ts>
+struct schema_dataframe_type<schema<Ts...>>
+{
+    using type = schema_dataframe<Ts...>;
+    using loader = schema_loader<Ts...>;
+};
+
+template<class schema_t>
+using schema_dataframe_of = typename schema_dataframe_type<schema_t>::type;
+
+/// @brief not very sophisticated print method
+template<class loader_t, int C>
+auto &operator<<(std::ostream &os, const dataframe<loader_t, C> &df)
+{
+    for( const auto &cell : df.col_iterable(df.header()) )
+        os << cell << '\t';
+    os << '\n';
+
+    for( const auto &row : df.row_iterable() )
+    {
+        for( const auto &cell : df.col_iterable(row) )
+            os << cell << '\t';
+        os << '\n';
+    }
+
+    return os;
+}
+
+/// @brief constructs a loader with the options and the dialect given by option tags
+template<class loader_t, class... options_t>
+auto make_loader(const std::filesystem::path &path, const options_t &... options)
+{
+    return std::make_shared<loader_t>(path, make_load_options(options...), dialect_of_t<options_t...>{});
+}
+
+/// @brief utility function to read csv-file
+/// @param options option tags like mcsv::parallel or mcsv::dialect
+template<int C = -1, class... options_t>
+auto read_csv(std::filesystem::path path, const options_t &... options)
+{
+    return dataframe<default_loader, C>(make_loader<default_loader>(path, options...));
+}
+
+/// @brief utility function to read csv-file with a compile-time schema, e.g.
+/// read_csv<mcsv::schema<int, double, std::string>>(path). The cells are converted to the
+/// column types while loading, see schema_loader.
+/// @param options option tags like mcsv::parallel or mcsv::columns
+template<class schema_t, class... options_t>
+auto read_csv(std::filesystem::path path, const options_t &... options)
+{
+    static_assert( is_schema_v<schema_t>, "template parameter must be a mcsv::schema" );
+
+    using dataframe_t = schema_dataframe_of<schema_t>;
+
+    return dataframe_t(make_loader<typename schema_dataframe_type<schema_t>::loader>(path, options...));
+}
+
+/// @brief utility function to read csv-file with the mmap_loader
+/// @param options option tags like mcsv::parallel
+template<int C = -1, class... options_t>
+auto read_csv_mmap(std::filesystem::path path, const options_t &... options)
+{
+    return dataframe<mmap_loader, C>(make_loader<mmap_loader>(path, options...));
+}
+
+/// @brief utility function to read csv-file with the columnar_loader
+/// @param options option tags like mcsv::parallel or mcsv::column_types
+template<int C = -1, class... options_t>
+auto read_csv_columnar(std::filesystem::path path, const options_t &... options)
+{
+    return dataframe<columnar_loader, C>(make_loader<columnar_loader>(path, options...));
+}
+
+/// @brief kind of a join: inner keeps only the matching rows, left keeps every row of the left dataframe
+enum class join_kind { inner, left };
+
+/// @brief Result of mcsv::join. Only the pairs of matching row indices are stored, the cells stay
+/// in the loaders of the two dataframes and are converted when they are extracted. The columns
+/// are the active columns of the left dataframe followed by those of the right dataframe.
+template<class left_loader_t, int LC, class right_loader_t, int RC>
+class join_result
+{
+public:
+    /// @brief right row index of a left row without match in a left join
+    static constexpr std::size_t no_match = std::numeric_limits<std::size_t>::max();
+
+private:
+    dataframe<left_loader_t, LC> m_left;
+    dataframe<right_loader_t, RC> m_right;
+    std::vector<std::pair<std::size_t, std::size_t>> m_pairs;
+
+    join_result(dataframe<left_loader_t, LC> left, dataframe<right_loader_t, RC> right,
+                std::vector<std::pair<std::size_t, std::size_t>> pairs) :
+        m_left(std::move(left)),
+        m_right(std::move(right)),
+        m_pairs(std::move(pairs))
+    {
+    }
+
+    /// @brief returns a cell of the joined table converted to T, a missing right row gives T{}
+    template<class T>
+    T cell(std::size_t pos, std::size_t col) const
+    {
+        const auto &left_cols = m_left.active_cols();
+        const auto [left_row, right_row] = m_pairs[pos];
+
+        if( col < left_cols.size() )
+            return m_left.template cell<T>(left_row, left_cols[col]);
+
+        if( right_row == no_match )
+            return T{};
+
+        return m_right.template cell<T>(right_row, m_right.active_cols()[col - left_cols.size()]);
+    }
+
+    /// @brief converts a column in parallel to a std::vector
+    template<class T>
+    std::vector<T> col_to_vector(std::size_t col, std::size_t threads) const
+    {
+        const auto n = m_pairs.size();
+        std::vector<T> vec(n);
+
+        // std::vector<bool> packs bits, so concurrent writes to it are not possible
+        const auto parts = std::is_same_v<T, bool> ? std::size_t{1} :
+            std::clamp(n / row_selection::min_parallel_rows, std::size_t{1}, std::max(threads, std::size_t{1}));
+
+        if( parts == 1 )
+        {
+            for(std::size_t i=0ul; i<n; ++i)
+                vec[i] = cell<T>(i, col);
+        }
+        else
+        {
+            run_parallel(parts, [&](std::size_t p) {
+                for(auto i = n * p / parts; i < n * (p + 1) / parts; ++i)
+                    vec[i] = cell<T>(i, col);
+            });
+        }
+
+        return vec;
+    }
+
+    template<class... Ts, std::size_t... idx>
+    auto cols_to_vector_tuple(std::size_t threads, std::index_sequence<idx...>) const
+    {
+        return std::tuple<std::vector<Ts>...>(col_to_vector<Ts>(idx, threads)...);
+    }
+
+public:
+    /// @brief implements mcsv::join. The right rows are inserted into an open-addressing hash
+    /// index over their typed keys, rows with equal keys are chained in visiting order. Then the
+    /// left rows are probed, in parallel parts, and the pairs are concatenated in left order.
+    template<class key_t>
+    static join_result build(dataframe<left_loader_t, LC> left, dataframe<right_loader_t, RC> right,
+                             const std::string &key, join_kind kind, std::size_t threads)
+    {
+        using value_t = std::remove_cv_t<std::remove_reference_t<key_t>>;
+
+        const auto left_key = left.column_index(key);
+        const auto right_key = right.column_index(key);
+
+        // build
+        group_index<value_t> index;
+        std::vector<value_t> keys;
+        std::vector<std::size_t> first, last, right_rows, next;
+
+        right.m_row_sel->for_each([&](std::size_t row) {
+            const auto g = index.find_or_insert(right.template cell<value_t>(row, right_key), keys);
+
+            if( g == first.size() )
+            {
+                first.push_back(right_rows.size());
+                last.push_back(right_rows.size());
+            }
+            else
+            {
+                next[last[g]] = right_rows.size();
+                last[g] = right_rows.size();
+            }
+
+            right_rows.push_back(row);
+            next.push_back(no_match);
+        });
+
+        // probe
+        const auto parts = left.m_row_sel->parts(threads);
+        std::vector<std::vector<std::pair<std::size_t, std::size_t>>> part_pairs(parts);
+
+        left.m_row_sel->for_each_part(parts, [&](std::size_t part, std::size_t row, std::size_t) {
+            auto &out = part_pairs[part];
+            const auto g = index.find(left.template cell<value_t>(row, left_key), keys);
+
+            if( g == keys.size() )
+            {
+                if( kind == join_kind::left )
+                    out.emplace_back(row, no_match);
+
+                return;
+            }
+
+            for(auto i = first[g]; i != no_match; i = next[i])
+                out.emplace_back(row, right_rows[i]);
+        });
+
+        auto pairs = std::move(part_pairs.front());
+        for(std::size_t p=1ul; p<parts; ++p)
+            pairs.insert(pairs.end(), part_pairs[p].begin(), part_pairs[p].end());
+
+        return join_result(std::move(left), std::move(right), std::move(pairs));
+    }
+
+    /// @brief returns the pairs of (left row, right row) indices into the loaders, the
+    /// right row is no_match for unmatched rows of a left join
+    const auto &pairs() const
+    {
+        return m_pairs;
+    }
+
+    /// @brief returns the left input dataframe
+    const auto &left() const
+    {
+        return m_left;
+    }
+
+    /// @brief returns the right input dataframe
+    const auto &right() const
+    {
+        return m_right;
+    }
+
+    /// @brief returns the number of joined rows
+    auto rows() const
+    {
+        return static_cast<std::ptrdiff_t>(m_pairs.size());
+    }
+
+    /// @brief returns the number of columns
+    auto cols() const
+    {
+        return m_left.cols() + m_right.cols();
+    }
+
+    /// @brief returns the names of the columns
+    std::vector<std::string> header() const
+    {
+        std::vector<std::string> names;
+
+        for(auto col : m_left.active_cols())
+            names.push_back(m_left.header()[col]);
+        for(auto col : m_right.active_cols())
+            names.push_back(m_right.header()[col]);
+
+        return names;
+    }
+
+    /// @brief extracts the columns as std::vectors, like dataframe::cols_to_vectors
+    /// @tparam Ts the types in which the columns can be converted
+    /// @param options option tags, e.g. mcsv::parallel{8} to convert the rows in parallel
+    /// @return a std::vector, if Ts is just one type, otherwise a std::tuple of std::vectors
+    template<typename... Ts, class... options_t>
+    auto cols_to_vectors(const options_t &... options) const
+    {
+        constexpr std::size_t N = sizeof...(Ts);
+
+        if( static_cast<std::size_t>(cols()) != N )
+            throw std::runtime_error(
+                fmt::format("{}: number of template parameters ({}) does not match number of cols ({})",
+                            __func__, N, cols())
+            );
+
+        const auto threads = make_load_options(options...).threads;
+
+        if constexpr( N == 1 )
+            return col_to_vector<Ts...>(0, threads);
+        else
+            return cols_to_vector_tuple<Ts...>(threads, std::index_sequence_for<Ts...>{});
+    }
+};
+
+/// @brief joins two dataframes, which can come from different csv-files, on equal values of a
+/// key column. Rows are matched by their active rows, the key column does not need to be active.
+/// Usage: auto joined = mcsv::join<int>(facts, lookup("id", "name"), "id", mcsv::join_kind::left);
+/// @tparam key_t type, in which the key columns are converted
+/// @param kind join_kind::inner or join_kind::left
+/// @param options option tags, e.g. mcsv::parallel{8} to probe the left rows in parallel
+template<class key_t = std::string, class left_loader_t, int LC, class right_loader_t, int RC, class... options_t>
+auto join(const dataframe<left_loader_t, LC> &left, const dataframe<right_loader_t, RC> &right,
+          const std::string &key, join_kind kind = join_kind::inner, const options_t &... options)
+{
+    return join_result<left_loader_t, LC, right_loader_t, RC>::template build<key_t>(
+        left, right, key, kind, make_load_options(options...).threads);
+}
+
+/// @brief Streaming reader for csv-files, which do not fit into memory. The file is read
+/// block-wise and next(n) returns the next n rows as an independent dataframe, so only the
+/// current batch and one block of the file are held in memory. Compressed files are
+/// decompressed on a background thread while the batches are tokenized (see input_stream).
+/// Usage: mcsv::csv_reader reader(path); while( auto batch = reader.next(65536) ) { ... }
+/// @tparam dialect_t the mcsv::dialect of the file
+template<class dialect_t>
+class basic_csv_reader
+{
+    using tokenizer_t = basic_tokenizer<dialect_t>;
+
+    input_stream m_file;
+    std::size_t m_block_size;
+    bool m_eof = false;
+
+    // bytes read from the file, which are not completely tokenized yet
+    std::string m_buffer;
+    tokenizer_t m_tok{std::string_view{}};
+
+    std::vector<std::string> m_header;
+    std::size_t m_rows_read = 0;
+
+    /// @brief appends the next block of the file to the buffer. Everything before keep_from
+    /// is removed, the tokenizer restarts at keep_from.
+    void fill(const char *keep_from)
+    {
+        m_buffer.erase(0, static_cast<std::size_t>(keep_from - m_buffer.data()));
+
+        const auto old_size = m_buffer.size();
+        m_buffer.resize(old_size + m_block_size);
+        const auto read = m_file.read(m_buffer.data() + old_size, m_block_size);
+        m_buffer.resize(old_size + read);
+        m_eof = ( read < m_block_size );
+
+        m_tok = tokenizer_t(m_buffer);
+    }
+
+    /// @brief tokenizes the next row into at most max_cells cells. A row is only complete, if
+    /// it ends before the end of the buffer (or at the end of the file), otherwise the next
+    /// block is read and the row is tokenized again. The cells are views into the buffer,
+    /// which are valid until the next call.
+    /// @return false, if the end of the file is reached
+    bool read_row(std::vector<std::pair<std::string_view, bool>> &row, std::size_t max_cells)
+    {
+        while( true )
+        {
+            const char *row_begin = m_tok.position();
+            row.clear();
+
+            const bool found = m_tok.next_row([&](auto cell, bool escaped) {
+                if( row.size() < max_cells )
+                    row.emplace_back(cell, escaped);
+            });
+
+            if( m_eof && !found )
+                return false;
+
+            if( found && ( m_eof || !m_tok.done() ) )
+                return true;
+
+            fill(row_begin);
+        }
+    }
+
+public:
+    /// @brief opens the file and reads the header
+    /// @param block_size number of bytes, which are read from the file at once
+    basic_csv_reader(std::filesystem::path path, std::size_t block_size = 1ul << 20) :
+        m_file(path, std::max(block_size, std::size_t{64})),
+        m_block_size(std::max(block_size, std::size_t{64}))
+    {
+        fill(m_buffer.data());
+
+        std::vector<std::pair<std::string_view, bool>> header;
+        read_row(header, std::numeric_limits<std::size_t>::max());
+
+        for(const auto &[cell, escaped] : header)
+            m_header.push_back(escaped ? tokenizer_t::unescape(cell) : std::string(cell));
+
+        // without header, the first row is only used to count the columns and read again
+        if constexpr( !dialect_t::header )
+        {
+            for(std::size_t i=0ul; i<m_header.size(); ++i)
+                m_header[i] = std::to_string(i);
+
+            m_tok = tokenizer_t(m_buffer);
+        }
+    }
+
+    /// @brief getter for the header of the csv-file
+    const auto &header() const
+    {
+        return m_header;
+    }
+
+    /// @brief returns the number of rows returned so far by next()
+    auto rows_read() const
+    {
+        return m_rows_read;
+    }
+
+    /// @brief reads the next batch of rows. As with the default_loader, rows with less cells
+    /// are filled with empty strings and longer rows are cut.
+    /// @param n maximum number of rows in the batch
+    /// @return dataframe over the batch, or std::nullopt if the end of the file is reached
+    std::optional<default_dataframe> next(std::size_t n)
+    {
+        const auto cols = m_header.size();
+
+        cell_arena cells;
+        std::size_t rows = 0;
+
+        std::vector<std::pair<std::string_view, bool>> row;
+        row.reserve(cols);
+
+        for(; rows < n && read_row(row, cols); ++rows)
+        {
+            for(const auto &[cell, escaped] : row)
+                cells.push(cell, escaped, dialect_t::quote);
+
+            for(auto i = row.size(); i < cols; ++i)
+                cells.push({});
+        }
+
+        if( rows == 0 )
+            return std::nullopt;
+
+        m_rows_read += rows;
+
+        return default_dataframe(std::make_shared<default_loader>(m_header, std::move(cells)));
+    }
+};
+
+using csv_reader = basic_csv_reader<dialect<>>;
+
+/// @brief read-only view on rows, which are stored in segments of segment_rows rows each
+/// (see async_loader). Behaves like a container of row_view objects.
+class segmented_table
+{
+public:
+    static constexpr unsigned segment_shift = 14;
+    static constexpr std::size_t segment_rows = std::size_t{1} << segment_shift;
+
+private:
+    const std::unique_ptr<std::string_view[]> *m_segments = nullptr;
+    std::size_t m_rows = 0;
+    std::size_t m_cols = 0;
+
+public:
+    /// @brief iterator over the rows, dereferences to a row_view
+    class const_iterator
+    {
+        const segmented_table *m_table;
+        std::size_t m_row;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = row_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = row_view;
+
+        const_iterator(const segmented_table *table, std::size_t row) :
+            m_table(table), m_row(row) {}
+
+        auto operator*() const { return (*m_table)[m_row]; }
+        auto &operator++() { ++m_row; return *this; }
+        bool operator==(const const_iterator &other) const { return m_row == other.m_row; }
+        bool operator!=(const const_iterator &other) const { return m_row != other.m_row; }
+    };
+
+    using value_type = row_view;
+    using iterator = const_iterator;
+
+    segmented_table() = default;
+    segmented_table(const std::unique_ptr<std::string_view[]> *segments, std::size_t rows, std::size_t cols) :
+        m_segments(segments), m_rows(rows), m_cols(cols) {}
+
+    auto begin() const { return const_iterator(this, 0); }
+    auto end() const { return const_iterator(this, m_rows); }
+    auto size() const { return m_rows; }
+
+    row_view operator[](std::size_t row) const
+    {
+        return row_view(m_segments[row >> segment_shift].get() + (row & (segment_rows - 1)) * m_cols, m_cols);
+    }
+};
+
+/// @brief Data storage class for a file, which is parsed on a background thread by
+/// read_csv_async. Like the mmap_loader, the cells are views into the mapped file. Each
+/// async_loader is an immutable snapshot of the rows, which were parsed when it was created,
+/// so dataframes stay consistent while the parsing continues.
+class async_loader
+{
+public:
+    /// @brief the progress of a parse, shared by the handle and all snapshots. Only the parsing
+    /// thread writes cells, and only into rows which are not yet published.
+    struct shared_state
+    {
+        mapped_file file;
+        std::string_view body;
+        std::vector<std::string> header;
+        std::map<std::string, std::size_t> header_map;
+        std::vector<std::size_t> slots;
+
+        // the segment table is allocated for the maximum number of rows, so it never reallocates
+        std::vector<std::unique_ptr<std::string_view[]>> segments;
+        std::deque<std::string> unescaped;
+
+        std::atomic<std::size_t> rows{0};
+        std::atomic<bool> stop{false};
+
+        mutable std::mutex mutex;
+        mutable std::condition_variable published;
+        bool done = false;
+        std::exception_ptr error;
+
+        /// @brief rows are published in batches of this size
+        static constexpr std::size_t publish_rows = 1024;
+
+        /// @brief maps a file of the given dialect and reads the header
+        template<class dialect_t>
+        shared_state(const std::filesystem::path &path, const load_options &options, dialect_t) :
+            file(path, options.threads)
+        {
+            const auto buffer = file.view();
+            basic_tokenizer<dialect_t> tok(buffer);
+
+            header = tok.read_header();
+
+            slots = options.project(header);
+
+            for(std::size_t i=0ul; i<header.size(); ++i)
+                if( !header_map.emplace(header[i], i).second )
+                    throw std::runtime_error("csv-file contains multiple columns with the same name!");
+
+            // each row needs at least one byte
+            body = buffer.substr(static_cast<std::size_t>(tok.position() - buffer.data()));
+            segments.resize(body.size() / segmented_table::segment_rows + 1);
+        }
+
+        /// @brief makes the first n rows visible
+        void publish(std::size_t n, bool finished)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                rows.store(n, std::memory_order_release);
+                done = finished;
+            }
+            published.notify_all();
+        }
+
+        /// @brief tokenizes the body row by row, until it is complete or stop is set. As with
+        /// the mmap_loader, rows with less cells are filled with empty cells, longer rows are cut.
+        /// @tparam dialect_t the dialect, with which the state is constructed
+        template<class dialect_t>
+        void parse()
+        {
+            using tokenizer_t = basic_tokenizer<dialect_t>;
+
+            try
+            {
+                const auto cols = header.size();
+                const char *end = body.data() + body.size();
+
+                tokenizer_t tok(body);
+                std::size_t row = 0;
+
+                while( tok.position() < end && !stop.load(std::memory_order_relaxed) )
+                {
+                    const auto local = row & (segmented_table::segment_rows - 1);
+                    auto &segment = segments[row >> segmented_table::segment_shift];
+
+                    if( local == 0 )
+                        segment = std::make_unique<std::string_view[]>(
+                            std::min(segmented_table::segment_rows, body.size() - row) * cols);
+
+                    auto *cells = segment.get() + local * cols;
+                    std::size_t n = 0;
+
+                    tok.next_row([&](auto cell, bool escaped) {
+                        const auto slot = n < slots.size() ? slots[n] : load_options::skip;
+                        ++n;
+
+                        if( slot != load_options::skip )
+                            cells[slot] = escaped ? std::string_view(unescaped.emplace_back(tokenizer_t::unescape(cell))) : cell;
+                    });
+
+                    if( ++row % publish_rows == 0 )
+                        publish(row, false);
+                }
+
+                publish(row, true);
+            }
+            catch(...)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    error = std::current_exception();
+                    done = true;
+                }
+                published.notify_all();
+            }
+        }
+
+        /// @brief blocks until at least n rows are published or the parse is finished
+        /// @return the number of published rows
+        std::size_t wait_for_rows(std::size_t n) const
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            published.wait(lock, [&]() { return done || rows.load(std::memory_order_relaxed) >= n; });
+
+            if( error )
+                std::rethrow_exception(error);
+
+            return rows.load(std::memory_order_relaxed);
+        }
+    };
+
+private:
+    std::shared_ptr<const shared_state> m_state;
+    segmented_table m_table;
+
+    mutable stats_recorder m_stats;
+    mutable zone_map_slot m_zones;
+
+public:
+    /// @brief snapshot of the first rows of a parse, which must already be published
+    async_loader(std::shared_ptr<const shared_state> state, std::size_t rows) :
+        m_state(std::move(state)),
+        m_table(m_state->segments.data(), rows, m_state->header.size())
+    {
+        MCSV_STATS_ADD(&m_stats, rows_parsed, rows);
+        MCSV_STATS_ADD(&m_stats, cells_parsed, rows * m_state->header.size());
+    }
+
+    /// @brief parses the whole file on the calling thread
+    async_loader(std::filesystem::path path, const load_options &options = {}) :
+        async_loader(path, options, dialect<>{})
+    {
+    }
+
+    /// @brief parses the whole file of the given dialect on the calling thread
+    template<class dialect_t>
+    async_loader(std::filesystem::path path, const load_options &options, dialect_t) :
+        async_loader(parse_all<dialect_t>(path, options))
+    {
+    }
+
+    async_loader(const async_loader &) = delete;
+    async_loader &operator=(const async_loader &) = delete;
+
+    /// @brief getter for the statistics of the queries
+    stats_recorder &recorder() const
+    {
+        return m_stats;
+    }
+
+    /// @brief getter for the zone map, which is set by dataframe::build_index
+    zone_map_slot &zones() const
+    {
+        return m_zones;
     }
 
-    /// @brief compares (!=) a dataframe with a tuple.
-    /// @return a dataframe, which contains only matching rows
-    template<class tuple_t>
-    auto operator!=(const tuple_t &tuple) const
+    /// @brief getter for the body of the csv-file
+    const auto &data() const
     {
-        return !( *this == tuple );
+        return m_table;
     }
 
-    /// @brief compares (<) a dataframe with a tuple.
-    /// @return a dataframe, which contains only matching rows
-    template<class tuple_t>
-    auto operator<(const tuple_t &tuple) const
+    /// @brief getter for the header of the csv-file
+    const auto &header() const
     {
-        return row_wise_comparison(std::less{}, tuple);
+        return m_state->header;
     }
 
-    /// @brief compares (<=) a dataframe with a tuple.
-    /// @return a dataframe, which contains only matching rows
-    template<class tuple_t>
-    auto operator<=(const tuple_t &tuple) const
+    /// @brief getter for a map, which relates indices and column-headers
+    const auto &header_map() const
     {
-        return row_wise_comparison(std::less_equal{}, tuple);
+        return m_state->header_map;
     }
 
-    /// @brief compares (>) a dataframe with a tuple.
-    /// @return a dataframe, which contains only matching rows
-    template<class tuple_t>
-    auto operator>(const tuple_t &tuple) const
+    /// @brief access a specific cell in the csv file
+    auto at(std::size_t row, std::size_t col) const
     {
-        return row_wise_comparison(std::greater{}, tuple);
+        if( m_table.size() <= row )
+            throw std::runtime_error(
+                fmt::format("{}: csv file has only {} rows, but row {} has been requested",
+                            __func__, m_table.size(), row));
+
+        if( header().size() <= col )
+            throw std::runtime_error(
+                fmt::format("{}: csv file has only {} cols, but col {} has been requested",
+                            __func__, header().size(), col));
+
+        return m_table[row][col];
     }
 
-    /// @brief compares (>=) a dataframe with a tuple.
-    /// @return a dataframe, which contains only matching rows
-    template<class tuple_t>
-    auto operator>=(const tuple_t &tuple) const
+private:
+    async_loader(std::shared_ptr<const shared_state> state) :
+        async_loader(state, state->rows.load(std::memory_order_acquire))
     {
-        return row_wise_comparison(std::greater_equal{}, tuple);
     }
-    
-    /// @brief filters rows with respect to a iterable. 
-    /// Dataframe needs to have exactly one active column!
-    /// TODO extend for tuples of vectors?
-    template<typename iterable_t,
-             typename = decltype(std::begin(std::declval<iterable_t>())),
-             typename = decltype(std::end(std::declval<iterable_t>()))>
-    auto is_in(const iterable_t &iterable) const
+
+    template<class dialect_t>
+    static std::shared_ptr<const shared_state> parse_all(const std::filesystem::path &path, const load_options &options)
     {
-        using T = typename iterable_t::value_type;
-        
-        static_assert( C == -1 || C == 1, "number of columns must be dynamic or 1");
-        
-        if( cols() != 1 )
-            throw std::runtime_error(
-                fmt::format("{}: number of columns must be 1!", __func__)
-            );
-        
-        const auto col_idx = std::find(m_col_mask.begin(), m_col_mask.end(), true) - m_col_mask.begin();
-        auto new_row_mask = m_row_mask;
-        
-        for(std::size_t i=0ul; i<new_row_mask.size(); ++i)
+        auto state = std::make_shared<shared_state>(path, options, dialect_t{});
+        state->template parse<dialect_t>();
+        state->wait_for_rows(std::numeric_limits<std::size_t>::max());
+        return state;
+    }
+};
+
+using async_dataframe = dataframe<async_loader>;
+
+/// @brief Handle of a file, which is parsed on a background thread (see read_csv_async). The
+/// header is available immediately, the rows as soon as they are parsed: wait_for_rows(n)
+/// blocks until the first n rows are available and snapshot() returns a dataframe over the
+/// rows parsed so far. Destroying the handle stops the parsing, existing snapshots stay valid.
+class async_csv
+{
+    std::shared_ptr<async_loader::shared_state> m_state;
+    std::thread m_worker;
+
+public:
+    /// @brief maps the file, reads the header and starts the parsing thread
+    template<class dialect_t = dialect<>>
+    async_csv(std::filesystem::path path, const load_options &options = {}, dialect_t = {}) :
+        m_state(std::make_shared<async_loader::shared_state>(path, options, dialect_t{}))
+    {
+        m_worker = std::thread([state = m_state]() { state->template parse<dialect_t>(); });
+    }
+
+    async_csv(async_csv &&) = default;
+    async_csv &operator=(async_csv &&) = delete;
+
+    ~async_csv()
+    {
+        if( m_worker.joinable() )
         {
-            if( new_row_mask[i] == true)
-            {
-                const T val = convert<T>(m_loader->data()[i][static_cast<std::size_t>(col_idx)]);
-            
-                if( std::none_of(iterable.begin(), iterable.end(), [&](auto a){ return a == val; }) )
-                    new_row_mask[i] = false;
-            }
+            m_state->stop = true;
+            m_worker.join();
         }
-        
-        return dataframe<loader_t, 1>(m_loader, new_row_mask, m_col_mask);
     }
 
-    /// @brief logical AND operator, only affects the row mask
-    template<int OC>
-    auto operator&&(const dataframe<loader_t, OC> &df) const
+    /// @brief getter for the header of the csv-file
+    const auto &header() const
     {
-        static_assert( C == -1 || C == OC, "number of columns does not match");
-
-        if( df.m_loader != m_loader )
-            throw std::runtime_error(
-                fmt::format("{}: cannot logically combine dataframes of differen csv-files", __func__)
-            );
+        return m_state->header;
+    }
 
-        std::vector<bool> new_row_mask(m_row_mask.size());
+    /// @brief number of rows parsed so far
+    std::size_t rows() const
+    {
+        return m_state->rows.load(std::memory_order_acquire);
+    }
 
-        for(std::size_t i=0ul; i<m_row_mask.size(); ++i)
-            new_row_mask[i] = m_row_mask[i] && df.m_row_mask[i];
+    /// @brief whether the whole file is parsed
+    bool done() const
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->done;
+    }
 
-        return dataframe<loader_t, C>(m_loader, new_row_mask, m_col_mask);
+    /// @brief blocks until at least n rows are parsed or the file is complete, and rethrows
+    /// an error of the parsing thread
+    /// @return the number of rows parsed so far, less than n only at the end of the file
+    std::size_t wait_for_rows(std::size_t n) const
+    {
+        return m_state->wait_for_rows(n);
     }
 
-    /// @brief logical OR operator, only affects the row mask
-    template<int OC>
-    auto operator||(const dataframe<loader_t, OC> &df) const
+    /// @brief returns a dataframe over the rows parsed so far
+    async_dataframe snapshot() const
     {
-        static_assert( C == -1 || C == OC, "number of columns does not match");
+        return async_dataframe(std::make_shared<async_loader>(m_state, rows()));
+    }
 
-        if( df.m_loader != m_loader )
-            throw std::runtime_error(
-                fmt::format("{}cannot logically combine dataframes of differen csv-files", __func__)
-            );
+    /// @brief waits until the whole file is parsed and returns a dataframe over all rows
+    async_dataframe get() const
+    {
+        const auto n = wait_for_rows(std::numeric_limits<std::size_t>::max());
+        return async_dataframe(std::make_shared<async_loader>(m_state, n));
+    }
+};
 
-        std::vector<bool> new_row_mask(m_row_mask.size());
+/// @brief utility function to read a csv-file on a background thread, e.g. to show the first
+/// rows of a large file before it is loaded completely. The file is parsed sequentially.
+/// @param options option tags like mcsv::columns
+/// @return an async_csv handle, whose snapshot() and get() return dataframes
+template<class... options_t>
+auto read_csv_async(std::filesystem::path path, const options_t &... options)
+{
+    return async_csv(path, make_load_options(options...), dialect_of_t<options_t...>{});
+}
 
-        for(std::size_t i=0ul; i<m_row_mask.size(); ++i)
-            new_row_mask[i] = m_row_mask[i] || df.m_row_mask[i];
+/// @brief table proxy of a sharded_loader, which maps the global row indices to the rows of the shards
+template<class loader_t>
+class sharded_table
+{
+    const std::vector<std::shared_ptr<loader_t>> *m_shards = nullptr;
+    const std::vector<std::size_t> *m_ends = nullptr;
 
-        return dataframe<loader_t, C>(m_loader, new_row_mask, m_col_mask);
-    }
+public:
+    using row_type = decltype(std::declval<const loader_t &>().data()[0]);
 
-    /// @brief filters the dataframe with respect to column names
-    /// @param args parameter-pack, which only is allowed to be of string-like types
-    template< class... Ts, typename = std::enable_if_t<std::conjunction_v< std::is_convertible<Ts,std::string>... >> >
-    auto operator()(Ts... args) const
+    /// @brief iterator over the rows, which walks through the shards one after another
+    class const_iterator
     {
-        std::tuple<Ts...> arg_tuple(args...);
-        constexpr std::size_t N = std::tuple_size_v<decltype(arg_tuple)>;
+        const sharded_table *m_table;
+        std::size_t m_row;
+        std::size_t m_shard = 0;
 
-        auto cols = string_tuple_to_array(arg_tuple, std::make_index_sequence<N> {});
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::decay_t<row_type>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = row_type;
 
-        std::vector<bool> new_col_mask(m_col_mask.size(), false);
-        for(const auto &col : cols)
+        const_iterator(const sharded_table *table, std::size_t row) :
+            m_table(table), m_row(row)
         {
-            new_col_mask[ m_loader->header_map().at(col) ] = true;
+            if( m_row < m_table->size() )
+                m_shard = m_table->shard_of(m_row);
         }
 
-        return dataframe<loader_t, static_cast<int>(N)>(m_loader, m_row_mask, new_col_mask);
-    }
+        decltype(auto) operator*() const
+        {
+            const auto begin = m_shard == 0 ? std::size_t{0} : (*m_table->m_ends)[m_shard - 1];
+            return (*m_table->m_shards)[m_shard]->data()[m_row - begin];
+        }
 
-    /// @brief filter the rows of a dataframe with help of another dataframe
-    /// @param df input-dataframe, from which the rows are used
-    /// @return dataframe, which has the rows of the input dataframe, but the original columns
-    template<int OC>
-    auto select_rows(const dataframe<loader_t, OC> &df) const
+        auto &operator++()
+        {
+            ++m_row;
+
+            // skips empty shards
+            while( m_row < m_table->size() && m_row >= (*m_table->m_ends)[m_shard] )
+                ++m_shard;
+
+            return *this;
+        }
+
+        bool operator==(const const_iterator &other) const { return m_row == other.m_row; }
+        bool operator!=(const const_iterator &other) const { return m_row != other.m_row; }
+    };
+
+    using value_type = std::decay_t<row_type>;
+    using iterator = const_iterator;
+
+    sharded_table() = default;
+    sharded_table(const std::vector<std::shared_ptr<loader_t>> *shards, const std::vector<std::size_t> *ends) :
+        m_shards(shards), m_ends(ends) {}
+
+    auto begin() const { return const_iterator(this, 0); }
+    auto end() const { return const_iterator(this, size()); }
+    std::size_t size() const { return m_ends->empty() ? 0 : m_ends->back(); }
+
+    /// @brief index of the shard, which contains a row
+    std::size_t shard_of(std::size_t row) const
     {
-        if( df.m_loader != m_loader )
-            throw std::runtime_error(
-                fmt::format("{}: cannot select rows based on a different csv-file.", __func__)
-            );
+        return static_cast<std::size_t>(std::upper_bound(m_ends->begin(), m_ends->end(), row) - m_ends->begin());
+    }
 
-        return dataframe<loader_t, C>(m_loader, df.m_row_mask, m_col_mask);
+    decltype(auto) operator[](std::size_t row) const
+    {
+        const auto shard = shard_of(row);
+        const auto begin = shard == 0 ? std::size_t{0} : (*m_ends)[shard - 1];
+        return (*m_shards)[shard]->data()[row - begin];
     }
+};
 
-    /// @brief filter the columns of a dataframe with help of another dataframe
-    /// @param df input-dataframe, from which the collumns are used
-    /// @return dataframe, which has the columns of the input dataframe, but the original rows
-    template<int OC>
-    auto select_cols(const dataframe<loader_t, OC> &df) const
+/// @brief Data storage class over several csv-files with the same header (shards), e.g. one file
+/// per day. Each shard is loaded by its own loader_t, in parallel with mcsv::parallel. The rows of
+/// the shards follow each other in the order of the files, nothing is copied: data(), at() and the
+/// typed access of loader_t (get<T>) are forwarded to the shard loaders.
+template<class loader_t>
+class sharded_loader
+{
+    std::vector<std::filesystem::path> m_paths;
+    std::vector<std::shared_ptr<loader_t>> m_shards;
+
+    // exclusive end row of each shard
+    std::vector<std::size_t> m_ends;
+    sharded_table<loader_t> m_table{&m_shards, &m_ends};
+
+    mutable stats_recorder m_stats;
+    mutable zone_map_slot m_zones;
+
+    /// @brief returns the shard and the row in the shard of a row
+    std::pair<std::size_t, std::size_t> locate(std::size_t row) const
     {
-        if( df.m_loader != m_loader )
-            throw std::runtime_error(
-                fmt::format("{}: cannot select rows based on a different csv-file.", __func__)
-            );
+        const auto shard = m_table.shard_of(row);
+        return {shard, row - (shard == 0 ? std::size_t{0} : m_ends[shard - 1])};
+    }
 
-        return dataframe<loader_t, C>(m_loader, m_row_mask, df.m_col_mask);
+public:
+    /// @brief loads all shards with the given options
+    sharded_loader(std::vector<std::filesystem::path> paths, const load_options &options = {}) :
+        sharded_loader(std::move(paths), options, dialect<>{})
+    {
     }
 
-    /// @brief extracts one ore more columns as std::vectors
-    /// @tparam Ts the types in which the columns can be converted
-    /// @return a std::vector, if Ts is just one type, otherwise a std::tuple of std::vectors
-    template<typename... Ts>
-    auto cols_to_vectors() const
+    /// @brief loads all shards of the given dialect. Up to options.threads shards are loaded at
+    /// the same time, each with its share of the threads.
+    /// @throw std::runtime_error, if no paths are given or the headers of the shards differ
+    template<class dialect_t>
+    sharded_loader(std::vector<std::filesystem::path> paths, const load_options &options, dialect_t) :
+        m_paths(std::move(paths)),
+        m_shards(m_paths.size())
     {
-        constexpr std::size_t N = std::tuple_size_v<std::tuple<Ts...>>;
+        if( m_paths.empty() )
+            throw std::runtime_error(fmt::format("{}: no csv-files given", __func__));
 
-        static_assert( C == -1 || C == static_cast<int>(N), "number of template parameters does not match number of cols");
+        const auto workers = std::clamp(options.threads, std::size_t{1}, m_paths.size());
 
-        if( N != cols() )
-            throw std::runtime_error(
-                fmt::format("{}: number of template parameters does not match number of cols", __func__)
-            );
+        auto shard_options = options;
+        shard_options.threads = std::max(options.threads / workers, std::size_t{1});
 
-        std::tuple< std::vector<Ts>... > result_tuple;
+        std::atomic<std::size_t> next{0};
 
-        for(const auto &row : row_iterable())
+        run_parallel(workers, [&](std::size_t) {
+            for(auto i = next++; i < m_paths.size(); i = next++)
+                m_shards[i] = std::make_shared<loader_t>(m_paths[i], shard_options, dialect_t{});
+        });
+
+        m_ends.reserve(m_shards.size());
+
+        for(std::size_t i=0ul; i<m_shards.size(); ++i)
         {
-            auto array = row_as_str_array<N>(row);
-            push_str_array_to_vector_tuple(result_tuple, array, std::make_index_sequence<N> {});
+            if( m_shards[i]->header() != m_shards.front()->header() )
+                throw std::runtime_error(
+                    fmt::format("{}: header of '{}' differs from the header of '{}'",
+                                __func__, m_paths[i].string(), m_paths.front().string()));
+
+            m_ends.push_back((i == 0 ? std::size_t{0} : m_ends.back()) + m_shards[i]->data().size());
+
+            if constexpr( has_stats_v<loader_t> )
+                m_stats.merge(m_shards[i]->recorder());
         }
+    }
 
-        if constexpr( N == 1ul )
-            return std::get<0>(result_tuple);
-        else
-            return result_tuple;
+    sharded_loader(const sharded_loader &) = delete;
+    sharded_loader &operator=(const sharded_loader &) = delete;
+
+    /// @brief getter for the statistics of the loading (of all shards) and of the queries
+    stats_recorder &recorder() const
+    {
+        return m_stats;
     }
 
-    /// @brief extracts all rows as std::vectors of a specific type
-    /// @tparam T the type in which the rows are converted
-    /// @return a std::vector of std::vector of T
-    template<typename T>
-    auto rows_to_vectors()
+    /// @brief getter for the zone map, which is set by dataframe::build_index
+    zone_map_slot &zones() const
     {
-        std::vector<std::vector<T>> vecs;
+        return m_zones;
+    }
 
-        for(const auto &row : row_iterable())
-            vecs.push_back( convert<T>(row) );
+    /// @brief getter for the paths of the shards
+    const auto &paths() const
+    {
+        return m_paths;
+    }
 
-        return vecs;
+    /// @brief getter for the loaders of the shards
+    const auto &shards() const
+    {
+        return m_shards;
     }
 
-    /// TODO
-    template<typename... Ts>
-    auto rows_to_tuples()
+    /// @brief getter for the body of all shards
+    const auto &data() const
     {
-        // should return std::vector of std::tuple<Ts...>
+        return m_table;
     }
 
-#ifdef MCSV_EIGEN_SUPPORT
+    /// @brief getter for the header, which is the same for all shards
+    const auto &header() const
+    {
+        return m_shards.front()->header();
+    }
 
-    /// @brief converts a csv-file in an Eigen::Array.
-    /// @tparam T the type of the Eigen::Array.
-    /// @tparam OR the rows of the Eigen::Array (-1 for Eigen::Dynamic)
-    /// @tparam OC the columns of the Eigen::Array (-1 for Eigen::Dynamic)
-    /// @return A fixed- or dynamic sized Eigen::Array
-    template<typename T, int OR = -1, int OC = -1>
-    auto to_eigen_array() const
+    /// @brief getter for a map, which relates indices and column-headers
+    const auto &header_map() const
     {
-        static_assert( OC == -1 || C == -1 || OC == C, "column number mismatch for fixed size eigen export");
+        return m_shards.front()->header_map();
+    }
 
-        if( OR != -1 && rows() != OR )
-            throw std::runtime_error(
-                fmt::format("{}: row number mismatch for fixed size eigen export", __func__)
-            );
+    /// @brief typed access to a cell, if the shard loaders provide it
+    template<class T, class = std::enable_if_t<has_typed_access_v<loader_t, T>>>
+    T get(std::size_t row, std::size_t col) const
+    {
+        const auto [shard, local] = locate(row);
+        return m_shards[shard]->template get<T>(local, col);
+    }
 
-        if( OC != -1 && cols() != OC )
+    /// @brief access a specific cell in the csv files
+    auto at(std::size_t row, std::size_t col) const
+    {
+        if( m_table.size() <= row )
             throw std::runtime_error(
-                fmt::format("{}: column number mismatch for fixed size eigen export", __func__)
-            );
-
-        Eigen::Array<T, OR, OC> array;
-        array.resize(rows(),cols());
-
-        Eigen::Index r = 0;
-        for(const auto &row : row_iterable())
-        {
-            Eigen::Index c = 0;
-            for(const auto &cell : col_iterable(row))
-            {
-                array(r,c) = convert<T>(cell);
-                ++c;
-            }
-            ++r;
-        }
+                fmt::format("{}: csv files have only {} rows, but row {} has been requested",
+                            __func__, m_table.size(), row));
 
-        return array;
+        const auto [shard, local] = locate(row);
+        return m_shards[shard]->at(local, col);
     }
+};
 
-    /// @brief converts a csv-file in an Eigen::Matrix.
-    /// @tparam T the type of the Eigen::Matrix.
-    /// @tparam OR the rows of the Eigen::Matrix (-1 for Eigen::Dynamic)
-    /// @tparam OC the columns of the Eigen::Matrix (-1 for Eigen::Dynamic)
-    /// @return A fixed- or dynamic sized Eigen::Matrix
-    template<typename T, int OR = -1, int OC = -1>
-    auto to_eigen_matrix() const
+/// @brief returns true, if a file name matches a pattern with the wildcards * and ?
+inline bool matches_wildcard(std::string_view name, std::string_view pattern)
+{
+    std::size_t n = 0, p = 0;
+    std::size_t star = std::string_view::npos, resume = 0;
+
+    while( n < name.size() )
     {
-        return to_eigen_array<T,OR,OC>().matrix();
+        if( p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n]) )
+        {
+            ++n;
+            ++p;
+        }
+        else if( p < pattern.size() && pattern[p] == '*' )
+        {
+            star = p++;
+            resume = n;
+        }
+        else if( star != std::string_view::npos )
+        {
+            // the last * takes one more character
+            p = star + 1;
+            n = ++resume;
+        }
+        else
+        {
+            return false;
+        }
     }
 
-#endif // CSV_EIGEN_SUPPORT
-};
+    while( p < pattern.size() && pattern[p] == '*' )
+        ++p;
 
-using default_dataframe = dataframe<default_loader>;
+    return p == pattern.size();
+}
 
-/// @brief not very sophisticated print method
-template<class loader_t, int C>
-auto &operator<<(std::ostream &os, const dataframe<loader_t, C> &df)
+/// @brief expands paths, whose file name contains the wildcards * or ?, to the matching
+/// regular files in sorted order. Other paths are kept as they are.
+/// @throw std::runtime_error, if a pattern matches no file or has wildcards in its directory
+inline std::vector<std::filesystem::path> expand_glob(const std::vector<std::filesystem::path> &patterns)
 {
-    for( const auto &cell : df.col_iterable(df.header()) )
-        os << cell << '\t';
-    os << '\n';
+    std::vector<std::filesystem::path> paths;
 
-    for( const auto &row : df.row_iterable() )
+    for(const auto &pattern : patterns)
     {
-        for( const auto &cell : df.col_iterable(row) )
-            os << cell << '\t';
-        os << '\n';
+        const auto has_wildcard = [](const std::string &s) { return s.find_first_of("*?") != std::string::npos; };
+        const auto name = pattern.filename().string();
+
+        if( has_wildcard(pattern.parent_path().string()) )
+            throw std::runtime_error(fmt::format("{}: wildcards are only allowed in the file name, not in '{}'", __func__, pattern.string()));
+
+        if( !has_wildcard(name) )
+        {
+            paths.push_back(pattern);
+            continue;
+        }
+
+        const auto dir = pattern.parent_path().empty() ? std::filesystem::path(".") : pattern.parent_path();
+        std::vector<std::filesystem::path> matches;
+
+        for(const auto &entry : std::filesystem::directory_iterator(dir))
+            if( entry.is_regular_file() && matches_wildcard(entry.path().filename().string(), name) )
+                matches.push_back(pattern.parent_path() / entry.path().filename());
+
+        if( matches.empty() )
+            throw std::runtime_error(fmt::format("{}: no file matches '{}'", __func__, pattern.string()));
+
+        std::sort(matches.begin(), matches.end());
+        paths.insert(paths.end(), matches.begin(), matches.end());
     }
 
-    return os;
+    return paths;
 }
 
-/// @brief utility function to read csv-file
-template<int C = -1>
-auto read_csv(std::filesystem::path path)
+/// @brief utility function to read several csv-files with the same header into one dataframe,
+/// see sharded_loader. Paths may contain the wildcards * and ? in the file name, e.g. "data/2024-*.csv".
+/// @tparam loader_t loader of the shards, e.g. mcsv::columnar_loader
+/// @param options option tags like mcsv::parallel, which are applied to all shards
+template<class loader_t = default_loader, int C = -1, class... options_t>
+auto read_csv_many(const std::vector<std::filesystem::path> &paths, const options_t &... options)
+{
+    return dataframe<sharded_loader<loader_t>, C>(std::make_shared<sharded_loader<loader_t>>(
+        expand_glob(paths), make_load_options(options...), dialect_of_t<options_t...>{}));
+}
+
+/// @brief read_csv_many with a single glob pattern, e.g. read_csv_many("data/2024-*.csv")
+template<class loader_t = default_loader, int C = -1, class pattern_t, class... options_t,
+         std::enable_if_t<std::is_convertible_v<const pattern_t &, std::string_view>, int> = 0>
+auto read_csv_many(const pattern_t &pattern, const options_t &... options)
 {
-    return dataframe<default_loader, C>(path);
+    return read_csv_many<loader_t, C>(std::vector<std::filesystem::path>{std::filesystem::path(std::string_view(pattern))}, options...);
 }
 
 } // namespace csv
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <fstream>
+#include <numeric>
 
 #include <mcsv/mcsv.hpp>
 
@@ -20,9 +22,653 @@ int main()
     std::vector<int> vec = {1,2,3,4,5,6,7,8,9,10};
     std::cout << df1.select_rows( df1("col1").is_in(vec) ) << "\n";
     
+    if( df1.select_rows( df1("col1","col4").is_in(std::vector<std::tuple<int,int>>{{1,4},{100,40}}) ).rows() != 1 )
+        throw std::runtime_error("is_in with tuples gives wrong result");
+    
+    std::vector<int> large_vec(1000);
+    std::iota(large_vec.begin(), large_vec.end(), 5);
+    
+    if( df1("col1").is_in(large_vec).rows() != 2 || df1("col1").is_in<int>(df1.select_rows(df1("col2") > std::tuple(10))("col1")).rows() != 2 )
+        throw std::runtime_error("is_in with hash set gives wrong result");
+    
     // logical test
     std::cout << "\nLOGICAL OPERATORS TEST\n";
     std::cout << df1.select_rows( df1("col2") < std::tuple(10) || df1("col3") > std::tuple(200) ) << "\n";
     
+    // mmap loader test
+    std::cout << "\nMMAP LOADER TEST\n";
+    auto df2 = mcsv::read_csv_mmap<4>(std::filesystem::current_path()/"test.csv");
+    std::cout << df2.select_rows( df2("col2") < std::tuple(10) || df2("col3") > std::tuple(200) ) << "\n";
+    
+    if( df2("col3","col4").cols_to_vectors<double, int>() != std::tuple(col3, col4) )
+        throw std::runtime_error("mmap_loader and default_loader give different results");
+    
+    // tokenizer test
+    std::cout << "\nQUOTED CELLS TEST\n";
+    auto df3 = mcsv::read_csv<3>(std::filesystem::current_path()/"test_quoted.csv");
+    auto df4 = mcsv::read_csv_mmap<3>(std::filesystem::current_path()/"test_quoted.csv");
+    std::cout << df3 << "\n";
+    
+    const std::vector<std::string> names = {"Doe, John", "plain", ""};
+    const std::vector<std::string> comments = {"said \"hi\"", "multi\nline", ""};
+    
+    if( df3("name","comment").cols_to_vectors<std::string, std::string>() != std::tuple(names, comments) ||
+        df4("name","comment").cols_to_vectors<std::string, std::string>() != std::tuple(names, comments) )
+        throw std::runtime_error("quoted cells are tokenized wrong");
+    
+    // columnar loader test
+    std::cout << "\nCOLUMNAR LOADER TEST\n";
+    {
+        auto df = mcsv::read_csv_columnar<4>(std::filesystem::current_path()/"test.csv",
+                                             mcsv::column_types{{"col4", mcsv::column_type::float64}});
+        std::cout << df.select_rows( df("col2") < std::tuple(10) || df("col3") > std::tuple(200) ) << "\n";
+        
+        auto loader = std::make_shared<mcsv::columnar_loader>(std::filesystem::current_path()/"test_quoted.csv");
+        
+        if( df.select_rows( df("col1").is_in(vec) )("col3","col4").cols_to_vectors<double, int>() != df1.select_rows( df1("col1").is_in(vec) )("col3","col4").cols_to_vectors<double, int>() ||
+            mcsv::columnar_dataframe(loader)("name","comment").cols_to_vectors<std::string, std::string>() != std::tuple(names, comments) ||
+            loader->type(1) != mcsv::column_type::int64 )
+            throw std::runtime_error("columnar_loader gives wrong results");
+
+        // values without an exact integer representation are rejected like by the default_loader
+        const auto lossy_path = std::filesystem::current_path()/"test_lossy.csv";
+        std::ofstream(lossy_path) << "a,b,c\n3.5,1e20,3000000000\n";
+
+        const auto columnar = mcsv::read_csv_columnar(lossy_path);
+        const auto rowwise = mcsv::read_csv(lossy_path);
+
+        for(const auto &col : {"a", "b", "c"})
+        {
+            bool columnar_thrown = false, rowwise_thrown = false;
+            try { columnar(col).cols_to_vectors<int>(); } catch(std::runtime_error &e) { columnar_thrown = true; std::cout << "expected error: " << e.what() << "\n"; }
+            try { rowwise(col).cols_to_vectors<int>(); } catch(std::runtime_error &) { rowwise_thrown = true; }
+
+            if( !columnar_thrown || !rowwise_thrown ||
+                columnar(col).cols_to_vectors<double>() != rowwise(col).cols_to_vectors<double>() )
+                throw std::runtime_error("columnar_loader and default_loader convert differently");
+        }
+
+        std::filesystem::remove(lossy_path);
+    }
+    
+    // filter kernel test, the columnar_loader uses kernels, the default_loader not
+    std::cout << "\nFILTER KERNEL TEST\n";
+    {
+        auto df = mcsv::read_csv_columnar<4>(std::filesystem::current_path()/"test.csv");
+        
+        const auto same = [&](const auto &a, const auto &b) {
+            return df.select_rows(a)("col1").template cols_to_vectors<int>() == df1.select_rows(b)("col1").template cols_to_vectors<int>();
+        };
+        
+        std::cout << df.select_rows( df("col2","col3") != std::tuple(20, 30.0) ) << "\n";
+        
+        if( !same( df("col2") < std::tuple(20), df1("col2") < std::tuple(20) ) ||
+            !same( df("col2") >= std::tuple(20), df1("col2") >= std::tuple(20) ) ||
+            !same( df("col3") == std::tuple(30.0), df1("col3") == std::tuple(30.0) ) ||
+            !same( df("col3") > std::tuple(3), df1("col3") > std::tuple(3) ) ||
+            !same( df("col2","col3") != std::tuple(20, 30.0), df1("col2","col3") != std::tuple(20, 30.0) ) ||
+            !same( df("col1").is_in(large_vec), df1("col1").is_in(large_vec) ) ||
+            (df("col2","col3") != std::tuple(20, 30.0)).rows() != 2 )
+            throw std::runtime_error("filter kernels give wrong results");
+    }
+    
+    // projection test, only the selected columns are loaded
+    std::cout << "\nCOLUMN PROJECTION TEST\n";
+    {
+        auto df = mcsv::read_csv(std::filesystem::current_path()/"test.csv", mcsv::columns{"col4", "col2"});
+        auto df_mmap = mcsv::read_csv_mmap<2>(std::filesystem::current_path()/"test.csv", mcsv::columns{"col4", "col2"});
+        auto df_columnar = mcsv::read_csv_columnar<2>(std::filesystem::current_path()/"test.csv", mcsv::columns{"col4", "col2"});
+        std::cout << df << "\n";
+        
+        const auto [col2, col4_int] = df1("col2","col4").cols_to_vectors<int, int>();
+        const auto expected = std::tuple(col4_int, col2);
+        
+        if( df.header() != std::vector<std::string>{"col4", "col2"} ||
+            df.cols_to_vectors<int, int>() != expected ||
+            df_mmap.cols_to_vectors<int, int>() != expected ||
+            df_columnar.cols_to_vectors<int, int>() != expected ||
+            df_mmap.select_rows( df_mmap("col2") > std::tuple(10) ).rows() != 2 )
+            throw std::runtime_error("column projection gives wrong results");
+        
+        bool thrown = false;
+        try { mcsv::read_csv(std::filesystem::current_path()/"test.csv", mcsv::columns{"col5"}); }
+        catch(std::runtime_error &e) { thrown = true; std::cout << "expected error: " << e.what() << "\n"; }
+        
+        if( !thrown )
+            throw std::runtime_error("projection of missing column does not throw");
+    }
+    
+    // export into caller-provided buffers
+    std::cout << "\nEXPORT INTO TEST\n";
+    {
+        const auto df = df1.select_rows( df1("col1") > std::tuple(5) )("col2","col4");
+        std::vector<int> row_major(4), col_major(4);
+        df.export_into(row_major.data(), mcsv::storage_order::row_major);
+        df.export_into(col_major.data(), mcsv::storage_order::col_major, mcsv::parallel{2});
+        
+        if( row_major != std::vector<int>{20, 40, 200, 400} || col_major != std::vector<int>{20, 200, 40, 400} )
+            throw std::runtime_error("export into raw buffers gives wrong results");
+        
+#ifdef MCSV_EIGEN_SUPPORT
+        Eigen::ArrayXXd buffer = Eigen::ArrayXXd::Zero(3, 3);
+        df.export_into(buffer.block(1, 1, 2, 2));
+        
+        Eigen::ArrayXXd expected = Eigen::ArrayXXd::Zero(3, 3);
+        expected.block(1, 1, 2, 2) << 20, 40, 200, 400;
+        
+        if( !(buffer == expected).all() )
+            throw std::runtime_error("export into eigen block gives wrong results");
+#endif
+    }
+    
+    // typed row records and struct of arrays
+    std::cout << "\nTUPLES AND SOA TEST\n";
+    {
+        const auto tuples = df1("col1","col3").rows_to_tuples<int, double>();
+        const auto arrays = df1("col1","col3").cols_to_soa<int, double>(mcsv::parallel{2});
+        
+        if( tuples != std::vector<std::tuple<int, double>>{{1, 3.0}, {10, 30.0}, {100, 300.0}} ||
+            arrays.size() != 3 || arrays.data<0>()[2] != 100 || arrays.data<1>()[1] != 30.0 ||
+            arrays[0] != std::tuple(1, 3.0) )
+            throw std::runtime_error("rows_to_tuples or cols_to_soa give wrong results");
+    }
+    
+    // lazy filter test, must give the same rows as the eager operators
+    std::cout << "\nLAZY FILTER TEST\n";
+    {
+        const auto eager = df1.select_rows( (df1("col2") < std::tuple(10) || df1("col3") > std::tuple(200)) && df1("col1") != std::tuple(1) );
+        const auto lazy = df1.select_rows( (df1("col2").lazy() < std::tuple(10) || df1("col3").lazy() > std::tuple(200)) && df1("col1").lazy() != std::tuple(1) );
+        std::cout << lazy << "\n";
+        
+        const auto subset = df1.select_rows( df1("col1") > std::tuple(5) );
+        const auto combined = subset.select_rows( subset("col1").lazy() == std::tuple(10) || df1("col1").lazy().is_in(std::vector<int>{1}) );
+        
+        if( lazy("col1").cols_to_vectors<int>() != eager("col1").cols_to_vectors<int>() ||
+            combined("col1").cols_to_vectors<int>() != std::vector<int>{1, 10} ||
+            df1.select_rows( !(df1("col2").lazy() >= std::tuple(20)) ).rows() != 1 )
+            throw std::runtime_error("lazy filters give wrong results");
+    }
+    
+    // conversion test
+    std::cout << "\nCONVERSION TEST\n";
+    {
+        bool thrown = false;
+        try { df3("name").cols_to_vectors<double>(); }
+        catch(std::runtime_error &e) { thrown = true; std::cout << "expected error: " << e.what() << "\n"; }
+        
+        if( !thrown || mcsv::convert<int>("3.0") != 3 || mcsv::convert<int>("+7") != 7 || mcsv::convert<double>("") != 0.0 ||
+            mcsv::convert<bool>("true") != true || mcsv::convert<float>("-1.5e2") != -150.f )
+            throw std::runtime_error("conversion gives wrong results");
+    }
+    
+    // dialects: other delimiters and quotes, untrimmed cells, comment rows and files without header
+    std::cout << "\nDIALECT TEST\n";
+    {
+        const auto path = std::filesystem::temp_directory_path()/"mcsv_test_dialect.csv";
+        std::ofstream(path) << "# comment, with | and '\nname| value\n'a|b'| 1 \n# another comment\n c |'it''s'\n";
+        
+        using pipe_quoted = mcsv::dialect<'|', '\'', false, '#'>;
+        const auto df = mcsv::read_csv(path, pipe_quoted{});
+        const auto trimmed = mcsv::read_csv_mmap(path, mcsv::dialect<'|', '\'', true, '#'>{});
+        const auto no_header = mcsv::read_csv_columnar(path, mcsv::dialect<'|', '\'', true, '#', false>{});
+        
+        const auto tsv_path = std::filesystem::temp_directory_path()/"mcsv_test_dialect.tsv";
+        std::ofstream(tsv_path) << "x\ty\n1\t\"a b\"\n 2\tc \n";
+        const auto tsv = mcsv::read_csv<mcsv::schema<int, std::string>>(tsv_path, mcsv::tsv_dialect{});
+        
+        mcsv::basic_csv_reader<pipe_quoted> reader(tsv_path);
+        
+        if( df.header() != std::vector<std::string>{"name", " value"} ||
+            df.cols_to_vectors<std::string, std::string>() != std::tuple(std::vector<std::string>{"a|b", " c "}, std::vector<std::string>{" 1 ", "it's"}) ||
+            trimmed.header() != std::vector<std::string>{"name", "value"} || trimmed("value").cols_to_vectors<std::string>() != std::vector<std::string>{"1", "it's"} ||
+            no_header.header() != std::vector<std::string>{"0", "1"} || no_header.rows() != 3 ||
+            tsv.cols_to_vectors<int, std::string>() != std::tuple(std::vector<int>{1, 2}, std::vector<std::string>{"a b", "c"}) ||
+            reader.header() != std::vector<std::string>{"x\ty"} || reader.next(10)->rows() != 2 )
+            throw std::runtime_error("dialects give wrong results");
+        
+        std::filesystem::remove(path);
+        std::filesystem::remove(tsv_path);
+    }
+    
+    // several files with the same header in one dataframe, the shards are not copied
+    std::cout << "\nMULTI-FILE TEST\n";
+    {
+        const auto dir = std::filesystem::temp_directory_path()/"mcsv_test_shards";
+        std::filesystem::create_directories(dir);
+        
+        for(int day=0; day<4; ++day)
+        {
+            std::ofstream shard(dir/("day-" + std::to_string(day) + ".csv"));
+            shard << "id,value\n";
+            for(int i=0; i<(day == 2 ? 0 : 100); ++i)
+                shard << day * 100 + i << "," << i * 0.5 << "\n";
+        }
+        
+        const auto df = mcsv::read_csv_many((dir/"day-*.csv").string(), mcsv::parallel{2});
+        const auto typed = mcsv::read_csv_many<mcsv::columnar_loader>({dir/"day-3.csv", dir/"day-0.csv"});
+        const auto [ids, values] = df.cols_to_vectors<int, double>();
+        
+        std::ofstream(dir/"day-9.csv") << "id,other\n1,2\n";
+        bool mismatch_detected = false;
+        try { mcsv::read_csv_many((dir/"day-*.csv").string()); } catch(std::runtime_error &) { mismatch_detected = true; }
+        
+        if( df.rows() != 300 || df.header() != std::vector<std::string>{"id", "value"} ||
+            ids.front() != 0 || ids[100] != 100 || ids.back() != 399 || values[150] != 25.0 ||
+            typed("id").cols_to_vectors<int>().front() != 300 || typed.select_rows( typed("id") < std::tuple(100) ).rows() != 100 ||
+            df.select_rows( df("id") >= std::tuple(300) && df("value") < std::tuple(10.0) ).rows() != 20 ||
+            !mismatch_detected )
+            throw std::runtime_error("multi-file loading gives wrong results");
+        
+        std::filesystem::remove_all(dir);
+    }
+    
+    // row selection test
+    std::cout << "\nROW SELECTION TEST\n";
+    {
+        auto all = mcsv::row_selection::all(10000);
+        auto few = mcsv::row_selection::from_indices(10000, {3, 64, 9999});
+        auto even = all.filter([](std::size_t i) { return i % 2 == 0; });
+        
+        const auto both = few & even;
+        const auto either = few | even;
+        
+        std::cout << "all: " << all.count() << ", few: " << few.count() << (few.sparse() ? " (sparse)" : " (dense)")
+                  << ", even: " << even.count() << (even.sparse() ? " (sparse)" : " (dense)") << "\n";
+        
+        if( all.count() != 10000 || even.count() != 5000 || both.indices() != std::vector<std::size_t>{64} ||
+            either.count() != 5002 || !few.sparse() || even.sparse() || !either.test(9999) || either.test(9997) )
+            throw std::runtime_error("row_selection gives wrong results");
+    }
+    
+    // parallel loading test, needs a file which is large enough to be split into chunks
+    std::cout << "\nPARALLEL LOADING TEST\n";
+    {
+        const auto path = std::filesystem::temp_directory_path()/"mcsv_test_parallel.csv";
+        std::ofstream file(path);
+        file << "id,text,value\n";
+        for(int i=0; i<100000; ++i)
+            file << i << (i % 7 == 0 ? ",\"multi\nline, \"\"quoted\"\"\"," : ",plain text,") << i * 0.5 << "\n";
+        file.close();
+        
+        auto seq = mcsv::read_csv(path);
+        auto par = mcsv::read_csv(path, mcsv::parallel{4});
+        auto par_mmap = mcsv::read_csv_mmap(path, mcsv::parallel{3});
+        
+        if( seq.rows() != 100000 ||
+            seq.cols_to_vectors<int, std::string, double>() != par.cols_to_vectors<int, std::string, double>() ||
+            seq.cols_to_vectors<int, std::string, double>() != par_mmap.cols_to_vectors<int, std::string, double>() )
+            throw std::runtime_error("parallel loading gives different results");
+        
+        std::cout << "loaded " << par.rows() << " rows in parallel\n";
+        
+        // group-by, the text column has two groups (hash aggregation), the id column
+        // only unique values (sort-based aggregation)
+        std::cout << "\nGROUPBY TEST\n";
+        const auto by_text = seq.groupby("text", mcsv::parallel{4}).agg(mcsv::count(), mcsv::sum("id"), mcsv::min("value"), mcsv::max("id"));
+        const auto by_id = seq.select_rows( seq("id") < std::tuple(70000) ).groupby<int>("id", mcsv::parallel{2}).agg(mcsv::mean("value"));
+        std::cout << by_text << "\n";
+        
+        const auto quoted = std::string("multi\nline, \"quoted\"");
+        const std::vector<std::string> text_keys = {quoted, "plain text"};
+        const std::vector<double> counts = {14286, 85714}, id_sums = {714264285, 4285685715}, max_ids = {99995, 99999};
+        
+        if( by_text.header() != std::vector<std::string>{"text", "count()", "sum(id)", "min(value)", "max(id)"} ||
+            by_text.cols_to_vectors<std::string, double, double, double, double>() != std::tuple(text_keys, counts, id_sums, std::vector<double>{0.0, 0.5}, max_ids) ||
+            by_id.rows() != 70000 || by_id.cols_to_vectors<int, double>() != seq.select_rows( seq("id") < std::tuple(70000) )("id","value").cols_to_vectors<int, double>() )
+            throw std::runtime_error("groupby gives wrong results");
+        
+        // sorting only permutes the rows, filters and exports follow the new order
+        std::cout << "\nSORTING TEST\n";
+        const auto by_value = seq.sort_by("value", false);
+        const auto by_text_then_id = seq.sort_by<std::string>("text");
+        const auto top = seq.top_k("value", 5, mcsv::parallel{4});
+        std::cout << top << "\n";
+        
+        std::vector<int> descending_ids(100000);
+        std::iota(descending_ids.rbegin(), descending_ids.rend(), 0);
+        const auto text_ids = by_text_then_id("id").cols_to_vectors<int>();
+        
+        if( by_value("id").cols_to_vectors<int>(mcsv::parallel{4}) != descending_ids ||
+            by_value("id").select_rows( by_value("id") < std::tuple(3) ).cols_to_vectors<int>() != std::vector<int>{2, 1, 0} ||
+            text_ids[0] != 0 || text_ids[1] != 7 || text_ids[14285] != 99995 || text_ids[14286] != 1 ||
+            top("id").cols_to_vectors<int>() != std::vector<int>{99999, 99998, 99997, 99996, 99995} ||
+            mcsv::radix_key(-1.5) >= mcsv::radix_key(-0.5) || mcsv::radix_key(-0.5) >= mcsv::radix_key(0.0) ||
+            mcsv::radix_key(0.0) >= mcsv::radix_key(2.0) || mcsv::radix_key(-3) >= mcsv::radix_key(1) )
+            throw std::runtime_error("sorting gives wrong results");
+        
+        // join of dataframes with different loaders, the key column does not need to be active
+        std::cout << "\nJOIN TEST\n";
+        const auto lookup = par_mmap.select_rows( par_mmap("id") < std::tuple(1000) );
+        const auto joined = mcsv::join<int>(seq("id","value"), lookup("text"), "id", mcsv::join_kind::left, mcsv::parallel{4});
+        const auto inner = mcsv::join<int>(seq("id"), lookup("value"), "id");
+        const auto [joined_ids, joined_values, joined_texts] = joined.cols_to_vectors<int, double, std::string>(mcsv::parallel{4});
+        const auto [seq_ids, seq_texts] = seq("id","text").cols_to_vectors<int, std::string>();
+        
+        auto expected_texts = seq_texts;
+        std::fill(expected_texts.begin() + 1000, expected_texts.end(), std::string{});
+        
+        if( joined.rows() != 100000 || joined.header() != std::vector<std::string>{"id", "value", "text"} ||
+            joined_ids != seq_ids || joined_texts != expected_texts || joined_values[10] != 5.0 ||
+            joined.pairs().back().second != joined.no_match || inner.rows() != 1000 ||
+            inner.cols_to_vectors<int, double>() != lookup("id","value").cols_to_vectors<int, double>() )
+            throw std::runtime_error("join gives wrong results");
+        
+        // the text column has only two distinct values, so it is dictionary-encoded
+        std::cout << "\nDICTIONARY ENCODING TEST\n";
+        auto loader = std::make_shared<mcsv::columnar_loader>(path);
+        auto plain = mcsv::columnar_loader(path, mcsv::make_load_options(mcsv::column_types{{"text", mcsv::column_type::string}}));
+        mcsv::columnar_dataframe columnar(loader);
+        
+        const auto same_rows = [&](const auto &a, const auto &b) {
+            return columnar.select_rows(a)("id").template cols_to_vectors<int>() == seq.select_rows(b)("id").template cols_to_vectors<int>();
+        };
+        
+        if( loader->type(1) != mcsv::column_type::category || plain.type(1) != mcsv::column_type::string ||
+            columnar.cols_to_vectors<int, std::string, double>() != seq.cols_to_vectors<int, std::string, double>() ||
+            !same_rows( columnar("text") == std::tuple(std::string("plain text")), seq("text") == std::tuple(std::string("plain text")) ) ||
+            !same_rows( columnar("text").is_in(std::vector<std::string>{"x", "plain text"}), seq("text").is_in(std::vector<std::string>{"x", "plain text"}) ) )
+            throw std::runtime_error("dictionary encoding gives wrong results");
+        
+        // the first load writes the snapshot, the second reads it, a corrupt snapshot is replaced
+        std::cout << "\nSNAPSHOT CACHE TEST\n";
+        {
+            const auto snapshot_path = std::filesystem::path(path.string() + ".mcsv");
+            std::filesystem::remove(snapshot_path);
+            
+            const auto expected = columnar.cols_to_vectors<int, std::string, double>();
+            const auto written = mcsv::read_csv_columnar(path, mcsv::snapshot{});
+            const auto written_size = std::filesystem::file_size(snapshot_path);
+            const auto cached = mcsv::read_csv_columnar(path, mcsv::snapshot{});
+            
+            // the cached columns are views on the snapshot, so they are compared before it is modified
+            if( cached.cols_to_vectors<int, std::string, double>() != expected )
+                throw std::runtime_error("snapshot cache gives wrong results");
+            
+            std::fstream corrupt(snapshot_path, std::ios::in | std::ios::out | std::ios::binary);
+            corrupt.seekp(-10, std::ios::end);
+            corrupt.put('x');
+            corrupt.close();
+            
+            // the corrupt column is detected on its first access, which removes the snapshot
+            const auto corrupted = mcsv::read_csv_columnar(path, mcsv::snapshot{});
+            bool thrown = false;
+            try { corrupted.cols_to_vectors<int, std::string, double>(); } catch(std::runtime_error &e) { thrown = true; std::cout << "expected error: " << e.what() << "\n"; }
+            
+            const auto recovered = mcsv::read_csv_columnar(path, mcsv::snapshot{});
+            const auto projected = mcsv::read_csv_columnar(path, mcsv::snapshot{}, mcsv::columns{"value"});
+            
+            if( written.cols_to_vectors<int, std::string, double>() != expected ||
+                !thrown ||
+                recovered.cols_to_vectors<int, std::string, double>() != expected ||
+                projected.header() != std::vector<std::string>{"value"} ||
+                std::filesystem::file_size(snapshot_path) == written_size )
+                throw std::runtime_error("snapshot cache gives wrong results");
+            
+            std::filesystem::remove(snapshot_path);
+        }
+        
+        // compile-time schema, the cells are converted while loading
+        std::cout << "\nSCHEMA TEST\n";
+        {
+            const auto typed = mcsv::read_csv<mcsv::schema<int, std::string, double>>(path, mcsv::parallel{3});
+            const auto projected = mcsv::read_csv<mcsv::schema<double, int>>(path, mcsv::columns{"value", "id"});
+            const auto &[ids, texts, values] = typed.cols_to_vectors();
+            
+            // on a temporary the loader dies with the dataframe, so the columns must be copies
+            static_assert( std::is_same_v<decltype(mcsv::read_csv<mcsv::schema<int, double>>(path).cols_to_vectors()),
+                                          std::tuple<std::vector<int>, std::vector<double>>> );
+            static_assert( std::is_same_v<decltype(typed.cols_to_vectors()),
+                                          std::tuple<const std::vector<int> &, const std::vector<std::string> &, const std::vector<double> &>> );
+            
+            const auto throws = [](const auto &fn) {
+                try { fn(); } catch(std::runtime_error &) { return true; }
+                return false;
+            };
+            
+            if( std::tie(ids, texts, values) != seq.cols_to_vectors<int, std::string, double>() ||
+                &std::get<0>(typed.cols_to_vectors()) != &ids ||
+                mcsv::read_csv<mcsv::schema<int, std::string, double>>(path).cols_to_vectors() != std::tie(ids, texts, values) ||
+                mcsv::read_csv<mcsv::schema<double>>(path, mcsv::columns{"value"}).cols_to_vectors() != values ||
+                typed.select_rows( typed("value") < std::tuple(100.0) )("id").cols_to_vectors<int>() !=
+                    seq.select_rows( seq("value") < std::tuple(100.0) )("id").cols_to_vectors<int>() ||
+                projected.header() != std::vector<std::string>{"value", "id"} ||
+                projected.cols_to_vectors<double, int>() != std::tuple(values, ids) ||
+                !throws([&]() { typed.select_rows( typed("id") < std::tuple(10) ).cols_to_vectors(); }) ||
+                !throws([&]() { mcsv::read_csv<mcsv::schema<int, int, double>>(path); }) ||
+                !throws([&]() { mcsv::read_csv<mcsv::schema<int, double>>(path); }) )
+                throw std::runtime_error("schema loading gives wrong results");
+        }
+        
+        // written files read back to the same cells, including quoted and typed cells
+        std::cout << "\nCSV WRITER TEST\n";
+        {
+            const auto out_path = std::filesystem::temp_directory_path()/"mcsv_test_out.csv";
+            const auto subset = by_value.select_rows( by_value("id") < std::tuple(50000) );
+            
+            subset.to_csv(out_path, mcsv::parallel{4});
+            const auto written_subset = mcsv::read_csv(out_path).cols_to_vectors<int, std::string, double>();
+            
+            columnar.to_csv(out_path);
+            const auto written_columnar = mcsv::read_csv(out_path).cols_to_vectors<int, std::string, double>();
+            
+            df3("name","comment").to_csv(out_path);
+            const auto written_quoted = mcsv::read_csv(out_path);
+
+            // the output follows the dialect given to to_csv: commas are not quoted, but the
+            // delimiter, the quote, the comment character and trimmed whitespaces are
+            using semicolon_dialect = mcsv::dialect<';', '\'', true, '#'>;
+            const std::vector<std::vector<std::string>> cells = {{"a,b", "a;b"}, {"it's", "#hash"}, {" padded", "\tx"}};
+            const auto dialect_df = mcsv::default_dataframe(std::make_shared<mcsv::default_loader>(std::vector<std::string>{"x", "y"}, cells));
+            
+            dialect_df.to_csv(out_path, semicolon_dialect{});
+            std::string first_line;
+            std::getline(std::ifstream(out_path) >> std::ws, first_line);
+            
+            const auto written_dialect = mcsv::read_csv(out_path, semicolon_dialect{});
+            
+            if( first_line != "x;y" ||
+                written_dialect.cols_to_vectors<std::string, std::string>() != std::tuple(std::vector<std::string>{"a,b", "it's", " padded"},
+                                                                                          std::vector<std::string>{"a;b", "#hash", "\tx"}) )
+                throw std::runtime_error("csv writer ignores the dialect");
+            
+            if( written_subset != subset.cols_to_vectors<int, std::string, double>() ||
+                written_columnar != seq.cols_to_vectors<int, std::string, double>() ||
+                written_quoted.header() != std::vector<std::string>{"name", "comment"} ||
+                written_quoted.cols_to_vectors<std::string, std::string>() != std::tuple(names, comments) )
+                throw std::runtime_error("csv writer gives wrong results");
+            
+            std::filesystem::remove(out_path);
+        }
+        
+        // parallel export, dense and sparse selections
+        auto sparse = seq.select_rows( seq("id") < std::tuple(7000) && seq("text") != std::tuple(std::string("plain text")) );
+        
+        if( par.cols_to_vectors<int, std::string, double>(mcsv::parallel{4}) != seq.cols_to_vectors<int, std::string, double>() ||
+            sparse.cols_to_vectors<int, std::string, double>(mcsv::parallel{3}) != sparse.cols_to_vectors<int, std::string, double>() ||
+            seq("id","value").rows_to_vectors<double>(mcsv::parallel{4}) != seq("id","value").rows_to_vectors<double>() )
+            throw std::runtime_error("parallel export gives different results");
+        
+#ifdef MCSV_EIGEN_SUPPORT
+        if( !(seq("id","value").to_eigen_array<double>(mcsv::parallel{4}) == seq("id","value").to_eigen_array<double>()).all() )
+            throw std::runtime_error("parallel eigen export gives different results");
+#endif
+        
+        // statistics are only recorded with MCSV_ENABLE_STATS
+        std::cout << "\nSTATS TEST\n";
+        {
+            auto instrumented = mcsv::read_csv(path);
+            instrumented.select_rows( instrumented("id") < std::tuple(1000) )("value").cols_to_vectors<double>();
+            const auto s = instrumented.stats();
+            std::cout << s << "\n";
+            
+#ifdef MCSV_ENABLE_STATS
+            if( s.rows_parsed != 100000 || s.cells_parsed != 300000 || s.bytes_read != std::filesystem::file_size(path) ||
+                s.filtered_rows != 100000 || s.passed_rows != 1000 || s.conversions != 1000 )
+#else
+            if( s.rows_parsed != 0 || s.filtered_rows != 0 )
+#endif
+                throw std::runtime_error("stats give wrong results");
+        }
+        
+        // zone maps, the sorted id and value columns allow to skip almost all blocks
+        std::cout << "\nZONE MAP TEST\n";
+        {
+            auto indexed = mcsv::read_csv(path);
+            auto typed = mcsv::read_csv_columnar(path);
+            indexed.build_index(mcsv::parallel{2});
+            typed.build_index();
+            
+            const auto few = indexed.select_rows( indexed("id") >= std::tuple(99990) );
+            const auto text = indexed.select_rows( indexed("text") == std::tuple(std::string("plain text")) );
+            const auto &block = indexed.index()->at(0, 1);
+            
+            if( !indexed.index() || indexed.index()->blocks() != (100000 + mcsv::zone_map::block_rows - 1) / mcsv::zone_map::block_rows ||
+                !block.integer || block.int_min != static_cast<std::int64_t>(mcsv::zone_map::block_rows) || block.nulls != 0 ||
+                few.cols_to_vectors<int, std::string, double>() != seq.select_rows( seq("id") >= std::tuple(99990) ).cols_to_vectors<int, std::string, double>() ||
+                text.rows() != seq.select_rows( seq("text") == std::tuple(std::string("plain text")) ).rows() ||
+                (indexed("value") < std::tuple(-1.0)).rows() != 0 || (indexed("id") <= std::tuple(1e9)).rows() != 100000 ||
+                (indexed("id") != std::tuple(5)).rows() != 99999 ||
+                indexed("id").is_in(std::vector<int>{-3, 17, 50000}).rows() != 2 ||
+                (typed("id", "value") < std::tuple(5000, 100.0)).rows() != 200 ||
+                typed("id").is_in(std::vector<int>{17, 123456}).rows() != 1 )
+                throw std::runtime_error("zone maps give wrong results");
+            
+            // the zone map is recorded by the loader, so separately constructed dataframes share it
+            const auto shared_loader = std::make_shared<mcsv::default_loader>(path);
+            const auto first = mcsv::default_dataframe(shared_loader);
+            first.build_index();
+            
+            if( !first.index() || mcsv::default_dataframe(shared_loader).index() != first.index() )
+                throw std::runtime_error("zone map is not shared by the dataframes over a loader");
+            
+#ifdef MCSV_ENABLE_STATS
+            if( indexed.stats().skipped_rows == 0 || typed.stats().skipped_rows == 0 )
+                throw std::runtime_error("zone maps skip no blocks");
+#endif
+        }
+        
+        // background loading, snapshots only contain the rows parsed when they are taken
+        std::cout << "\nASYNC LOADING TEST\n";
+        {
+            const auto handle = mcsv::read_csv_async(path);
+            const auto available = handle.wait_for_rows(10);
+            const auto first = handle.snapshot();
+            const auto all = handle.get();
+            const auto head = seq.select_rows( seq("id") < std::tuple(static_cast<int>(first.rows())) );
+            
+            if( handle.header() != seq.header() || available < 10 || first.rows() < static_cast<std::ptrdiff_t>(available) || !handle.done() ||
+                first.cols_to_vectors<int, std::string, double>() != head.cols_to_vectors<int, std::string, double>() ||
+                all.cols_to_vectors<int, std::string, double>() != seq.cols_to_vectors<int, std::string, double>() ||
+                mcsv::read_csv_async(path, mcsv::columns{"value"}).get().cols_to_vectors<double>() != seq("value").cols_to_vectors<double>() )
+                throw std::runtime_error("async loading gives wrong results");
+            
+            // the parsing is stopped, if the handle is destroyed early
+            mcsv::read_csv_async(path);
+            
+            std::cout << "first snapshot had " << first.rows() << " rows\n";
+        }
+        
+        // compressed files are detected by their magic number and decompressed transparently
+        std::cout << "\nCOMPRESSION TEST\n";
+        {
+            const auto gz_path = std::filesystem::path(path.string() + ".gz");
+            std::ifstream original(path, std::ios::binary);
+            const std::string content((std::istreambuf_iterator<char>(original)), std::istreambuf_iterator<char>());
+            
+#ifdef MCSV_ZLIB_SUPPORT
+            // two gzip members, the second one starts inside of a row
+            for(const auto &[mode, part] : {std::pair("wb", content.substr(0, content.size() / 2)), std::pair("ab", content.substr(content.size() / 2))})
+            {
+                gzFile gz = gzopen(gz_path.c_str(), mode);
+                gzwrite(gz, part.data(), static_cast<unsigned>(part.size()));
+                gzclose(gz);
+            }
+            
+            mcsv::csv_reader reader(gz_path, 4096);
+            std::vector<int> ids;
+            while( auto batch = reader.next(10000) )
+            {
+                const auto batch_ids = batch->cols_to_vectors<int, std::string, double>();
+                ids.insert(ids.end(), std::get<0>(batch_ids).begin(), std::get<0>(batch_ids).end());
+            }
+            
+            const auto expected = seq.cols_to_vectors<int, std::string, double>();
+            
+            if( mcsv::read_csv(gz_path, mcsv::parallel{2}).cols_to_vectors<int, std::string, double>() != expected ||
+                mcsv::read_csv_columnar(gz_path).cols_to_vectors<int, std::string, double>() != expected ||
+                ids != std::get<0>(expected) || reader.header() != seq.header() )
+                throw std::runtime_error("compressed loading gives wrong results");
+            
+            // a truncated file is an error
+            std::filesystem::resize_file(gz_path, std::filesystem::file_size(gz_path) - 100);
+#else
+            std::ofstream(gz_path, std::ios::binary) << "\x1f\x8b" << content.substr(0, 100);
+#endif
+            bool thrown = false;
+            try { mcsv::read_csv(gz_path); } catch(std::runtime_error &e) { thrown = true; std::cout << e.what() << "\n"; }
+            
+            if( !thrown )
+                throw std::runtime_error("unsupported or truncated compressed file gives no error");
+            
+            std::filesystem::remove(gz_path);
+
+#ifdef MCSV_ZSTD_SUPPORT
+            // the decompressed size is a multiple of the output step and the compressed
+            // size a multiple of the block size, so a frame ends exactly at a boundary
+            const auto zst_path = std::filesystem::path(path.string() + ".zst");
+            std::string rows = "id,text\n";
+            for(int i=0; rows.size() < 2ul << 16; ++i)
+                rows += fmt::format("{:05},y\n", i);
+
+            std::string compressed(ZSTD_compressBound(rows.size()), '\0');
+            compressed.resize(ZSTD_compress(compressed.data(), compressed.size(), rows.data(), rows.size(), 3));
+            std::ofstream(zst_path, std::ios::binary) << compressed;
+
+            mcsv::csv_reader zst_reader(zst_path, compressed.size());
+            std::size_t zst_rows = 0;
+            while( auto batch = zst_reader.next(10000) )
+                zst_rows += static_cast<std::size_t>(batch->rows());
+
+            const auto zst_ids = mcsv::read_csv(zst_path)("id").cols_to_vectors<int>();
+
+            if( rows.size() != 2ul << 16 || zst_rows != (rows.size() - 8) / 8 || zst_ids.size() != zst_rows || zst_ids.back() != static_cast<int>(zst_rows) - 1 )
+                throw std::runtime_error("zstd loading gives wrong results");
+
+            // a truncated frame is an error
+            std::ofstream(zst_path, std::ios::binary) << compressed.substr(0, compressed.size() - 10);
+
+            thrown = false;
+            try { mcsv::read_csv(zst_path); } catch(std::runtime_error &e) { thrown = true; std::cout << e.what() << "\n"; }
+
+            if( !thrown )
+                throw std::runtime_error("truncated zstd file gives no error");
+
+            std::filesystem::remove(zst_path);
+#endif
+        }
+        
+        // streaming reader, the small blocks split rows and quoted cells
+        std::cout << "\nSTREAMING READER TEST\n";
+        mcsv::csv_reader reader(path, 1000);
+        std::vector<int> ids;
+        std::vector<std::string> texts;
+        
+        while( auto batch = reader.next(4096) )
+        {
+            const auto [batch_ids, batch_texts] = (*batch)("id","text").cols_to_vectors<int, std::string>();
+            ids.insert(ids.end(), batch_ids.begin(), batch_ids.end());
+            texts.insert(texts.end(), batch_texts.begin(), batch_texts.end());
+            
+            if( batch->rows() > 4096 || batch->select_rows( (*batch)("id") < std::tuple(0) ).rows() != 0 )
+                throw std::runtime_error("streaming reader gives wrong batches");
+        }
+        
+        if( reader.rows_read() != 100000 || std::tie(ids, texts) != seq("id","text").cols_to_vectors<int, std::string>() )
+            throw std::runtime_error("streaming reader gives different results");
+        
+        std::cout << "streamed " << reader.rows_read() << " rows\n";
+        std::filesystem::remove(path);
+    }
+    
     return 0;
 }